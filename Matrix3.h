@@ -0,0 +1,124 @@
+#ifndef _Matrix3_h_
+#define _Matrix3_h_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "Vector3.h"
+
+
+//******************************************************************************
+/// A 3x3 matrix, stored in row-major order, for rotating and transforming
+/// Vector3 values. All of the basic operations are constexpr, and the type holds
+/// its elements inline (no heap).
+//******************************************************************************
+template<typename T> struct Matrix3
+{
+    T m[3][3];
+
+    //*************************************************************************
+    // Constructors
+    //*************************************************************************
+
+    // Constructs an identity matrix
+    constexpr Matrix3() : m{ {1, 0, 0}, {0, 1, 0}, {0, 0, 1} } {};
+
+    constexpr Matrix3(const T m00, const T m01, const T m02,
+                      const T m10, const T m11, const T m12,
+                      const T m20, const T m21, const T m22)
+        : m{ {m00, m01, m02}, {m10, m11, m12}, {m20, m21, m22} } {};
+
+    // Constructs a matrix from its three rows
+    constexpr Matrix3(const Vector3<T>& r0, const Vector3<T>& r1, const Vector3<T>& r2)
+        : m{ {r0.x, r0.y, r0.z}, {r1.x, r1.y, r1.z}, {r2.x, r2.y, r2.z} } {};
+
+    static constexpr Matrix3<T> Identity() { return Matrix3<T>(); };
+
+    static constexpr Matrix3<T> Zero() { return Matrix3<T>(0, 0, 0, 0, 0, 0, 0, 0, 0); };
+
+    //*************************************************************************
+    // Operations
+    //*************************************************************************
+    constexpr Vector3<T> Row(const uint8_t i) const { return Vector3<T>(m[i][0], m[i][1], m[i][2]); };
+
+    constexpr Vector3<T> Column(const uint8_t j) const { return Vector3<T>(m[0][j], m[1][j], m[2][j]); };
+
+    constexpr Matrix3<T> Transpose() const
+    {
+        return Matrix3<T>(m[0][0], m[1][0], m[2][0],
+                          m[0][1], m[1][1], m[2][1],
+                          m[0][2], m[1][2], m[2][2]);
+    };
+
+    constexpr T Determinant() const
+    {
+        return m[0][0] * (m[1][1]*m[2][2] - m[1][2]*m[2][1])
+             - m[0][1] * (m[1][0]*m[2][2] - m[1][2]*m[2][0])
+             + m[0][2] * (m[1][0]*m[2][1] - m[1][1]*m[2][0]);
+    };
+
+    // Transforms an array of vectors: out[i] = M * in[i]. The arrays may be the same.
+    void Transform(const Vector3<T>* in, Vector3<T>* out, size_t count) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const T x = in[i].x, y = in[i].y, z = in[i].z;
+
+            out[i].x = m[0][0]*x + m[0][1]*y + m[0][2]*z;
+            out[i].y = m[1][0]*x + m[1][1]*y + m[1][2]*z;
+            out[i].z = m[2][0]*x + m[2][1]*y + m[2][2]*z;
+        }
+    };
+
+    //*************************************************************************
+    // Operators
+    //*************************************************************************
+
+    // Matrix-vector product
+    constexpr Vector3<T> operator*(const Vector3<T>& v) const
+    {
+        return Vector3<T>(m[0][0]*v.x + m[0][1]*v.y + m[0][2]*v.z,
+                          m[1][0]*v.x + m[1][1]*v.y + m[1][2]*v.z,
+                          m[2][0]*v.x + m[2][1]*v.y + m[2][2]*v.z);
+    };
+
+    // Matrix-matrix product
+    constexpr Matrix3<T> operator*(const Matrix3<T>& b) const
+    {
+        return Matrix3<T>(m[0][0]*b.m[0][0] + m[0][1]*b.m[1][0] + m[0][2]*b.m[2][0],
+                          m[0][0]*b.m[0][1] + m[0][1]*b.m[1][1] + m[0][2]*b.m[2][1],
+                          m[0][0]*b.m[0][2] + m[0][1]*b.m[1][2] + m[0][2]*b.m[2][2],
+                          m[1][0]*b.m[0][0] + m[1][1]*b.m[1][0] + m[1][2]*b.m[2][0],
+                          m[1][0]*b.m[0][1] + m[1][1]*b.m[1][1] + m[1][2]*b.m[2][1],
+                          m[1][0]*b.m[0][2] + m[1][1]*b.m[1][2] + m[1][2]*b.m[2][2],
+                          m[2][0]*b.m[0][0] + m[2][1]*b.m[1][0] + m[2][2]*b.m[2][0],
+                          m[2][0]*b.m[0][1] + m[2][1]*b.m[1][1] + m[2][2]*b.m[2][1],
+                          m[2][0]*b.m[0][2] + m[2][1]*b.m[1][2] + m[2][2]*b.m[2][2]);
+    };
+
+    // Matrix scalar multiplication
+    constexpr Matrix3<T> operator*(const T s) const
+    {
+        return Matrix3<T>(m[0][0]*s, m[0][1]*s, m[0][2]*s,
+                          m[1][0]*s, m[1][1]*s, m[1][2]*s,
+                          m[2][0]*s, m[2][1]*s, m[2][2]*s);
+    };
+
+    constexpr Matrix3<T> operator+(const Matrix3<T>& b) const
+    {
+        return Matrix3<T>(m[0][0]+b.m[0][0], m[0][1]+b.m[0][1], m[0][2]+b.m[0][2],
+                          m[1][0]+b.m[1][0], m[1][1]+b.m[1][1], m[1][2]+b.m[1][2],
+                          m[2][0]+b.m[2][0], m[2][1]+b.m[2][1], m[2][2]+b.m[2][2]);
+    };
+
+    constexpr Matrix3<T> operator-(const Matrix3<T>& b) const
+    {
+        return Matrix3<T>(m[0][0]-b.m[0][0], m[0][1]-b.m[0][1], m[0][2]-b.m[0][2],
+                          m[1][0]-b.m[1][0], m[1][1]-b.m[1][1], m[1][2]-b.m[1][2],
+                          m[2][0]-b.m[2][0], m[2][1]-b.m[2][1], m[2][2]-b.m[2][2]);
+    };
+};
+
+
+typedef Matrix3<float> Matrix3F;
+
+#endif
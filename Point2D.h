@@ -1,9 +1,18 @@
 #ifndef _Point2D_h_
 #define _Point2D_h_
 
+#include <math.h>
+#include <inttypes.h>
+
 
 //******************************************************************************
 /// A struct that contains a 2D X-Y point. 
+///
+/// R() and Angle() are cached: each is computed on first use and then returned 
+/// from the cache until X or Y changes, so repeated reads cost a compare and a 
+/// load instead of a sqrt() or atan2(). The cache costs RAM: a Point2D takes 25
+/// bytes on AVR (28 with padding on 32-bit targets) rather than the 8 of its two
+/// fields.
 //******************************************************************************
 
 struct Point2D
@@ -14,17 +23,50 @@ struct Point2D
     /***************************************************************************
     Constructors
     ***************************************************************************/
-    public: Point2D() : X(0), Y(0) { };
+    public: Point2D() : X(0), Y(0), _cacheX(NAN), _cacheY(NAN), _cached(0) { };
 
-    public: Point2D(float x, float y) : X(x), Y(y) { };
+    public: Point2D(float x, float y) : X(x), Y(y), _cacheX(NAN), _cacheY(NAN), _cached(0) { };
     
     /***************************************************************************
     Public implementation
     ***************************************************************************/
     
-    public: float R() { return sqrt(X*X + Y*Y); };
+    public: float R() const
+    {
+        Validate();
+
+        if (!(_cached & CACHED_R)) { _r = sqrt(X*X + Y*Y); _cached |= CACHED_R; }
+
+        return _r;
+    };
     
-    public: float Angle() { return (X == 0 && Y == 0) ? 0.0 : atan2(Y, X); };
+    public: float Angle() const
+    {
+        Validate();
+
+        if (!(_cached & CACHED_ANGLE)) { _angle = (X == 0 && Y == 0) ? 0.0 : atan2(Y, X); _cached |= CACHED_ANGLE; }
+
+        return _angle;
+    };
+
+    /***************************************************************************
+    Private implementation
+    ***************************************************************************/
+
+    // Discards the cached values if X or Y has changed since they were computed
+    private: inline void Validate() const
+    {
+        if (X != _cacheX || Y != _cacheY) { _cacheX = X; _cacheY = Y; _cached = 0; }
+    };
+
+    private: static const uint8_t CACHED_R = 0x01;
+    private: static const uint8_t CACHED_ANGLE = 0x02;
+
+    private: mutable float _cacheX;
+    private: mutable float _cacheY;
+    private: mutable float _r;
+    private: mutable float _angle;
+    private: mutable uint8_t _cached;
 };
 
 #endif
@@ -2,7 +2,9 @@
 #define _PolarVector2D_h_
 
 #include <math.h>
+#include <stddef.h>
 #include "RTL_Math.h"
+#include "Point2D.h"
 
 
 //******************************************************************************
@@ -11,6 +13,11 @@
 ///
 /// Positive angles are counter-clockwise (rotating leftward from the +y axis)
 /// and negative angles are clockwise (rotating rightward from the +y axis).
+///
+/// The Cartesian components are cached: the first call to X() or Y() after 
+/// Radius or Angle changes computes both components from a single SinCos()
+/// evaluation, and further calls just return the cached values. The cache costs
+/// RAM: a PolarVector2D takes 24 bytes rather than the 8 of its two fields.
 //******************************************************************************
 struct PolarVector2D
 {
@@ -20,16 +27,64 @@ struct PolarVector2D
     /***************************************************************************
     Constructors
     ***************************************************************************/
-    public: PolarVector2D(float radius, float angle=0) : Radius(radius), Angle(angle) { };
+    public: PolarVector2D(float radius, float angle=0) : Radius(radius), Angle(angle), _cacheRadius(NAN), _cacheAngle(NAN) { };
     
     /***************************************************************************
     Public implementation
     ***************************************************************************/
     
-    public: float X() const { return Radius * cos(radians(Angle)); };
+    public: float X() const { Validate(); return _x; };
     
-    public: float Y() const { return Radius * sin(radians(Angle)); };
+    public: float Y() const { Validate(); return _y; };
+
+    /***************************************************************************
+    Private implementation
+    ***************************************************************************/
+
+    // Recomputes both cached components if Radius or Angle has changed
+    private: inline void Validate() const
+    {
+        if (Radius != _cacheRadius || Angle != _cacheAngle)
+        {
+            float s, c;
+
+            SinCos(radians(Angle), s, c);
+
+            _x = Radius * c;
+            _y = Radius * s;
+            _cacheRadius = Radius;
+            _cacheAngle = Angle;
+        }
+    };
+
+    private: mutable float _cacheRadius;
+    private: mutable float _cacheAngle;
+    private: mutable float _x;
+    private: mutable float _y;
 };
 
-#endif
 
+//******************************************************************************
+/// Converts an array of polar vectors to Cartesian points.
+//******************************************************************************
+inline void ToCartesian(const PolarVector2D* vectors, Point2D* points, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        points[i].X = vectors[i].X();
+        points[i].Y = vectors[i].Y();
+    }
+}
+
+//******************************************************************************
+/// Converts an array of Cartesian points to polar vectors (angles in degrees).
+//******************************************************************************
+inline void ToPolar(const Point2D* points, PolarVector2D* vectors, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        vectors[i] = PolarVector2D(points[i].R(), degrees(points[i].Angle()));
+    }
+}
+
+#endif
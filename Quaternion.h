@@ -0,0 +1,136 @@
+#ifndef _Quaternion_h_
+#define _Quaternion_h_
+
+#include <math.h>
+#include <stddef.h>
+#include "RTL_Math.h"
+#include "Vector3.h"
+#include "Matrix3.h"
+
+
+//******************************************************************************
+/// A quaternion (w + xi + yj + zk), used to represent 3D rotations. A rotation
+/// quaternion must have unit length; use Normalize() after accumulating updates.
+///
+/// Rotate() applies the rotation to a vector directly, without building a
+/// rotation matrix (15 multiplies instead of the ~30 it takes to build the
+/// matrix and apply it). When rotating a block of vectors, the array version of
+/// Rotate() builds the matrix once instead, which is cheaper per vector.
+//******************************************************************************
+template<typename T> struct Quaternion
+{
+    T w;
+    T x;
+    T y;
+    T z;
+
+    //*************************************************************************
+    // Constructors
+    //*************************************************************************
+
+    // Constructs the identity rotation
+    constexpr Quaternion() : w(1), x(0), y(0), z(0) {};
+
+    constexpr Quaternion(const T pw, const T px, const T py, const T pz) : w(pw), x(px), y(py), z(pz) {};
+
+    // Constructs a rotation of angle radians about a unit-length axis
+    static Quaternion<T> FromAxisAngle(const Vector3<T>& axis, const T angle)
+    {
+        const T s = sin(angle / 2);
+
+        return Quaternion<T>(cos(angle / 2), axis.x * s, axis.y * s, axis.z * s);
+    };
+
+    //*************************************************************************
+    // Operations
+    //*************************************************************************
+    constexpr T Dot(const Quaternion<T>& q) const { return w*q.w + x*q.x + y*q.y + z*q.z; };
+
+    constexpr T NormSquared() const { return Dot(*this); };
+
+    // The inverse of a unit quaternion (i.e. the opposite rotation)
+    constexpr Quaternion<T> Conjugate() const { return Quaternion<T>(w, -x, -y, -z); };
+
+    // The vector (imaginary) part
+    constexpr Vector3<T> Vector() const { return Vector3<T>(x, y, z); };
+
+    //*************************************************************************
+    /// Scales the quaternion to unit length. This uses the fast invsqrt() plus
+    /// one more Newton iteration, which is accurate to a few parts per million
+    /// (invsqrt() alone is only good to ~0.2%, which would visibly shrink vectors
+    /// rotated by the result).
+    //*************************************************************************
+    Quaternion<T>& Normalize()
+    {
+        const T n = NormSquared();
+        T k = invsqrt(n);
+
+        k = k * (T(1.5) - T(0.5) * n * k * k);
+        w *= k; x *= k; y *= k; z *= k;
+
+        return *this;
+    };
+
+    Quaternion<T> Normalized() const { Quaternion<T> q(*this); return q.Normalize(); };
+
+    //*************************************************************************
+    /// Rotates a vector by this (unit) quaternion: v' = q v q*
+    ///
+    /// Computed as t = 2(q.xyz × v); v' = v + w·t + q.xyz × t
+    //*************************************************************************
+    Vector3<T> Rotate(const Vector3<T>& v) const
+    {
+        const T tx = 2 * (y*v.z - z*v.y);
+        const T ty = 2 * (z*v.x - x*v.z);
+        const T tz = 2 * (x*v.y - y*v.x);
+
+        return Vector3<T>(v.x + w*tx + (y*tz - z*ty),
+                          v.y + w*ty + (z*tx - x*tz),
+                          v.z + w*tz + (x*ty - y*tx));
+    };
+
+    // Rotates an array of vectors. The arrays may be the same.
+    void Rotate(const Vector3<T>* in, Vector3<T>* out, size_t count) const
+    {
+        if (count < 3)
+        {
+            for (size_t i = 0; i < count; i++) out[i] = Rotate(in[i]);
+        }
+        else
+        {
+            ToMatrix().Transform(in, out, count);
+        }
+    };
+
+    // The equivalent rotation matrix
+    constexpr Matrix3<T> ToMatrix() const
+    {
+        return Matrix3<T>(1 - 2*(y*y + z*z),     2*(x*y - w*z),     2*(x*z + w*y),
+                              2*(x*y + w*z), 1 - 2*(x*x + z*z),     2*(y*z - w*x),
+                              2*(x*z - w*y),     2*(y*z + w*x), 1 - 2*(x*x + y*y));
+    };
+
+    //*************************************************************************
+    // Operators
+    //*************************************************************************
+
+    // Hamilton product (the rotation rhs followed by this rotation)
+    constexpr Quaternion<T> operator*(const Quaternion<T>& q) const
+    {
+        return Quaternion<T>(w*q.w - x*q.x - y*q.y - z*q.z,
+                             w*q.x + x*q.w + y*q.z - z*q.y,
+                             w*q.y - x*q.z + y*q.w + z*q.x,
+                             w*q.z + x*q.y - y*q.x + z*q.w);
+    };
+
+    constexpr Quaternion<T> operator*(const T s) const { return Quaternion<T>(w*s, x*s, y*s, z*s); };
+
+    constexpr Quaternion<T> operator+(const Quaternion<T>& q) const { return Quaternion<T>(w+q.w, x+q.x, y+q.y, z+q.z); };
+
+    constexpr Quaternion<T> operator-(const Quaternion<T>& q) const { return Quaternion<T>(w-q.w, x-q.x, y-q.y, z-q.z); };
+};
+
+
+typedef Quaternion<float> QuaternionF;
+
+#endif
@@ -0,0 +1,144 @@
+/*******************************************************************************
+ This module implements the MahonyAHRS class. The algorithm follows Mahony et
+ al., "Nonlinear Complementary Filters on the Special Orthogonal Group" (2008),
+ in the quaternion form popularized by S. Madgwick's reference implementation.
+*******************************************************************************/
+
+#include <math.h>
+#include <Arduino.h>
+#include "RTL_Math.h"
+#include "RTL_CycleCounter.h"
+#include "RTL_AHRS.h"
+
+
+MahonyAHRS::MahonyAHRS(float kp, float ki) : _twoKp(2 * kp), _twoKi(2 * ki), _cycles(0)
+{
+    Reset();
+}
+
+
+void MahonyAHRS::Reset()
+{
+    _q = QuaternionF();
+    _integral.Zero();
+}
+
+
+void MahonyAHRS::Update(const Vector3F& gyro, const Vector3F& accel, const Vector3F& mag, float dt)
+{
+    uint32_t start = CycleCount();
+
+    Fuse(gyro, accel, mag.IsZero() ? NULL : &mag, dt);
+
+    _cycles = CycleCount() - start;
+}
+
+
+void MahonyAHRS::Update(const Vector3F& gyro, const Vector3F& accel, float dt)
+{
+    uint32_t start = CycleCount();
+
+    Fuse(gyro, accel, NULL, dt);
+
+    _cycles = CycleCount() - start;
+}
+
+
+void MahonyAHRS::Update(const Vector3F* gyro, const Vector3F* accel, const Vector3F* mag, size_t count, float dt)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        Fuse(gyro[i], accel[i], (mag != NULL && !mag[i].IsZero()) ? &mag[i] : NULL, dt);
+    }
+}
+
+
+void MahonyAHRS::Fuse(const Vector3F& gyro, const Vector3F& accel, const Vector3F* mag, float dt)
+{
+    const float q0 = _q.w, q1 = _q.x, q2 = _q.y, q3 = _q.z;
+    float gx = gyro.x, gy = gyro.y, gz = gyro.z;
+
+    // Accelerometer feedback is only possible if there is a gravity measurement
+    if (!accel.IsZero())
+    {
+        const float q0q0 = q0*q0, q0q1 = q0*q1, q0q2 = q0*q2, q0q3 = q0*q3;
+        const float q1q1 = q1*q1, q1q2 = q1*q2, q1q3 = q1*q3;
+        const float q2q2 = q2*q2, q2q3 = q2*q3;
+        const float q3q3 = q3*q3;
+
+        Vector3F a = accel * invsqrt(accel.Dot(accel));
+
+        // Half the estimated direction of gravity
+        Vector3F v(q1q3 - q0q2, q0q1 + q2q3, q0q0 - 0.5f + q3q3);
+
+        // Half the error: cross product of measured and estimated directions
+        Vector3F e = a.Cross(v);
+
+        if (mag != NULL)
+        {
+            Vector3F m = *mag * invsqrt(mag->Dot(*mag));
+
+            // Reference direction of the Earth's magnetic field
+            float hx = 2 * (m.x * (0.5f - q2q2 - q3q3) + m.y * (q1q2 - q0q3) + m.z * (q1q3 + q0q2));
+            float hy = 2 * (m.x * (q1q2 + q0q3) + m.y * (0.5f - q1q1 - q3q3) + m.z * (q2q3 - q0q1));
+            float h2 = hx * hx + hy * hy;
+            float bx = (h2 > 0) ? h2 * invsqrt(h2) : 0;
+            float bz = 2 * (m.x * (q1q3 - q0q2) + m.y * (q2q3 + q0q1) + m.z * (0.5f - q1q1 - q2q2));
+
+            // Half the estimated direction of the magnetic field
+            Vector3F w(bx * (0.5f - q2q2 - q3q3) + bz * (q1q3 - q0q2),
+                       bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3),
+                       bx * (q0q2 + q1q3) + bz * (0.5f - q1q1 - q2q2));
+
+            e += m.Cross(w);
+        }
+
+        if (_twoKi > 0)
+        {
+            _integral += e * (_twoKi * dt);
+            gx += _integral.x;
+            gy += _integral.y;
+            gz += _integral.z;
+        }
+        else
+        {
+            _integral.Zero();
+        }
+
+        gx += _twoKp * e.x;
+        gy += _twoKp * e.y;
+        gz += _twoKp * e.z;
+    }
+
+    // Integrate the rate of change of the quaternion: q' = ½ q ⊗ (0, g)
+    gx *= 0.5f * dt;
+    gy *= 0.5f * dt;
+    gz *= 0.5f * dt;
+
+    _q.w = q0 + (-q1 * gx - q2 * gy - q3 * gz);
+    _q.x = q1 + ( q0 * gx + q2 * gz - q3 * gy);
+    _q.y = q2 + ( q0 * gy - q1 * gz + q3 * gx);
+    _q.z = q3 + ( q0 * gz + q1 * gy - q2 * gx);
+
+    _q.Normalize();
+}
+
+
+float MahonyAHRS::Roll() const
+{
+    return atan2(_q.w * _q.x + _q.y * _q.z, 0.5f - _q.x * _q.x - _q.y * _q.y);
+}
+
+
+float MahonyAHRS::Pitch() const
+{
+    float s = -2 * (_q.x * _q.z - _q.w * _q.y);
+
+    return asin(constrain(s, -1.0f, 1.0f));
+}
+
+
+float MahonyAHRS::Yaw() const
+{
+    return atan2(_q.x * _q.y + _q.w * _q.z, 0.5f - _q.y * _q.y - _q.z * _q.z);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef _RTL_AHRS_h_
+#define _RTL_AHRS_h_
+/*******************************************************************************
+ * Header file for the MahonyAHRS (attitude and heading reference system) class.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "Vector3.h"
+#include "Quaternion.h"
+
+
+//******************************************************************************
+/// A Mahony complementary filter that fuses gyroscope, accelerometer and
+/// (optionally) magnetometer samples into an orientation quaternion.
+///
+/// Gyro rates are integrated to propagate the orientation, and the error between
+/// the measured and predicted directions of gravity (and magnetic north) is fed
+/// back through a proportional-integral controller to correct gyro drift. With
+/// Ki = 0 this is a plain complementary filter.
+///
+/// The filter allocates nothing and uses only multiplies, adds and the fast
+/// invsqrt() from RTL_Math in its update (no division, sqrt or trig), so an
+/// update is cheap enough to run at 1 kHz even on a Cortex-M0 class part.
+///
+/// Gyro rates are in radians/second. Accelerometer and magnetometer samples can
+/// be in any units, since only their directions are used. The time cost of
+/// each update is available from LastUpdateCycles() (see RTL_CycleCounter.h for
+/// its resolution).
+//******************************************************************************
+class MahonyAHRS
+{
+    public: MahonyAHRS(float kp=0.5f, float ki=0.0f);
+
+    public: void Reset();
+
+    public: inline void SetGains(float kp, float ki) { _twoKp = 2 * kp; _twoKi = 2 * ki; };
+
+    //**************************************************************************
+    /// Updates the orientation with one set of samples taken dt seconds after
+    /// the previous set. A magnetometer sample of (0,0,0) is ignored.
+    //**************************************************************************
+    public: void Update(const Vector3F& gyro, const Vector3F& accel, const Vector3F& mag, float dt);
+
+    public: void Update(const Vector3F& gyro, const Vector3F& accel, float dt);
+
+    //**************************************************************************
+    /// Updates the orientation with a block of samples taken dt seconds apart,
+    /// e.g. to replay a log on the host. mag may be NULL.
+    //**************************************************************************
+    public: void Update(const Vector3F* gyro, const Vector3F* accel, const Vector3F* mag, size_t count, float dt);
+
+    public: inline const QuaternionF& Orientation() const { return _q; };
+
+    // Euler angles in radians (not computed in the update, so these cost some trig)
+    public: float Roll() const;
+    public: float Pitch() const;
+    public: float Yaw() const;
+
+    // CPU cycles taken by the most recent single-sample update
+    public: inline uint32_t LastUpdateCycles() const { return _cycles; };
+
+    private: void Fuse(const Vector3F& gyro, const Vector3F& accel, const Vector3F* mag, float dt);
+
+    private: QuaternionF _q;
+    private: Vector3F _integral;        // Integral feedback term
+    private: float _twoKp;
+    private: float _twoKi;
+    private: uint32_t _cycles;
+};
+
+#endif
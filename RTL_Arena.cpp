@@ -0,0 +1,96 @@
+/*******************************************************************************
+ This module implements the Arena (monotonic scratch allocator) class and the
+ formatting and parsing helpers that allocate from it.
+*******************************************************************************/
+
+#include <string.h>
+#include <Arduino.h>
+#include "RTL_Arena.h"
+
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+    uintptr_t top = uintptr_t(_buffer + _used);
+    size_t padding = size_t(-top) & (alignment - 1);
+
+    if (padding + size > _size - _used) return NULL;
+
+    void* p = _buffer + _used + padding;
+
+    _used += padding + size;
+
+    if (_used > _peak) _peak = _used;
+
+    return p;
+}
+
+
+char* Arena::Duplicate(const char* s, size_t length)
+{
+    length = strnlen(s, length);
+
+    char* copy = static_cast<char*>(Allocate(length + 1, 1));
+
+    if (copy != NULL)
+    {
+        memcpy(copy, s, length);
+        copy[length] = '\0';
+    }
+
+    return copy;
+}
+
+
+char* Arena::Duplicate(const char* s)
+{
+    return Duplicate(s, strlen(s));
+}
+
+
+ArenaPrint::ArenaPrint(Arena& arena) : _arena(arena), _length(0), _overflow(false)
+{
+    _text = static_cast<char*>(_arena.Allocate(1, 1));
+
+    if (_text != NULL)
+        _text[0] = '\0';
+    else
+        _overflow = true;
+}
+
+
+size_t ArenaPrint::write(uint8_t c)
+{
+    if (_overflow) return 0;
+
+    // The string can only grow if it is still at the top of the arena
+    char* next = static_cast<char*>(_arena.Allocate(1, 1));
+
+    if (next != _text + _length + 1)
+    {
+        if (next != NULL) _arena.Reset(_arena.Mark() - 1);
+
+        _overflow = true;
+        return 0;
+    }
+
+    _text[_length++] = char(c);
+    *next = '\0';
+
+    return 1;
+}
+
+
+char* AsciiToToken(const char*& p, Arena& arena, const char* delimiters)
+{
+    p += strspn(p, delimiters);
+
+    size_t length = strcspn(p, delimiters);
+
+    if (length == 0) return NULL;
+
+    char* token = arena.Duplicate(p, length);
+
+    if (token != NULL) p += length;
+
+    return token;
+}
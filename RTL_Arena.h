@@ -0,0 +1,165 @@
+#pragma once
+#ifndef _RTL_Arena_h_
+#define _RTL_Arena_h_
+/*******************************************************************************
+ * Header file for the Arena (monotonic scratch allocator) class.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_Stdlib.h"
+
+
+//******************************************************************************
+/// A monotonic (bump) allocator over a fixed buffer. Allocation is just a pointer
+/// increment, and memory is never freed individually - instead, the whole arena
+/// (or everything allocated since a Mark()) is released at once with Reset().
+///
+/// This is intended for per-loop scratch data: formatted log lines, parsed
+/// tokens, temporary vector blocks, and the like. Typical usage:
+///
+///     StaticArena<256> scratch;
+///
+///     void loop()
+///     {
+///         ArenaScope scope(scratch);      // Everything below is released at end of loop()
+///         char* token = AsciiToToken(p, scratch);
+///         ...
+///     }
+///
+/// Destructors are NOT run when memory is released, so only objects that do not
+/// need destruction should be placed in an arena. The arena is not interrupt-safe
+/// and should only be used from one context.
+//******************************************************************************
+class Arena
+{
+    public: typedef size_t Marker;
+
+    public: Arena(void* buffer, size_t size) : _buffer(static_cast<uint8_t*>(buffer)), _size(size), _used(0), _peak(0) { };
+
+    //**************************************************************************
+    /// Allocates size bytes aligned to the specified boundary (which must be a
+    /// power of two). Returns NULL if there is not enough space left.
+    //**************************************************************************
+    public: void* Allocate(size_t size, size_t alignment=__BIGGEST_ALIGNMENT__);
+
+    //**************************************************************************
+    /// Allocates uninitialized, properly aligned storage for count objects of type T.
+    //**************************************************************************
+    public: template <typename T> T* Allocate(size_t count=1)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    //**************************************************************************
+    /// Allocates and constructs an object of type T. The object's destructor will
+    /// not be called when the arena is reset.
+    //**************************************************************************
+    public: template <typename T, typename... Args> T* Create(Args&&... args)
+    {
+        void* p = Allocate(sizeof(T), alignof(T));
+
+        return (p != NULL) ? new (p) T(Forward<Args>(args)...) : NULL;
+    }
+
+    //**************************************************************************
+    /// Copies up to length characters of a string into the arena and null
+    /// terminates the copy. Returns NULL if there is not enough space left.
+    //**************************************************************************
+    public: char* Duplicate(const char* s, size_t length);
+
+    public: char* Duplicate(const char* s);
+
+    //**************************************************************************
+    /// Mark() captures the current allocation position. Reset(mark) releases
+    /// everything allocated since the mark was taken; Reset() releases everything.
+    //**************************************************************************
+    public: inline Marker Mark() const { return _used; };
+
+    public: inline void Reset(Marker mark=0) { if (mark < _used) _used = mark; };
+
+    public: inline size_t Capacity() const { return _size; };
+
+    public: inline size_t Used() const { return _used; };
+
+    public: inline size_t Available() const { return _size - _used; };
+
+    // The largest number of bytes that have been in use at the same time
+    public: inline size_t Peak() const { return _peak; };
+
+    public: inline void ResetPeak() { _peak = _used; };
+
+    private: uint8_t* _buffer;
+    private: size_t _size;
+    private: size_t _used;
+    private: size_t _peak;
+};
+
+
+//******************************************************************************
+/// An Arena that owns a statically sized buffer.
+//******************************************************************************
+template <size_t _arena_size> class StaticArena : public Arena
+{
+    public: StaticArena() : Arena(_storage, _arena_size) { };
+
+    private: alignas(__BIGGEST_ALIGNMENT__) uint8_t _storage[_arena_size];
+};
+
+
+//******************************************************************************
+/// Releases everything allocated from an arena during the lifetime of the scope
+/// object (RAII wrapper around Mark() and Reset(mark)).
+//******************************************************************************
+class ArenaScope
+{
+    public: ArenaScope(Arena& arena) : _arena(arena), _mark(arena.Mark()) { };
+
+    public: ~ArenaScope() { _arena.Reset(_mark); };
+
+    private: Arena& _arena;
+    private: Arena::Marker _mark;
+};
+
+
+//******************************************************************************
+/// A Print stream that formats into an arena-allocated string, so the usual
+/// streaming operators can build text without a worst-case sized char[]:
+///
+///     ArenaPrint line(scratch);
+///     line << millis() << F(": x=") << x;
+///     Send(line.c_str(), line.length());
+///
+/// The string grows in place at the top of the arena and is always null
+/// terminated. Allocating anything else from the arena while the string is
+/// being built ends the string; further output is dropped and Overflow()
+/// becomes true (as it does if the arena fills up).
+//******************************************************************************
+class ArenaPrint : public Print
+{
+    public: ArenaPrint(Arena& arena);
+
+    public: virtual size_t write(uint8_t c);
+
+    public: inline const char* c_str() const { return (_text != NULL) ? _text : ""; };
+
+    public: inline size_t length() const { return _length; };
+
+    public: inline bool Overflow() const { return _overflow; };
+
+    private: Arena& _arena;
+    private: char* _text;
+    private: size_t _length;
+    private: bool _overflow;
+};
+
+
+//******************************************************************************
+/// Extracts the next token from a string, skipping leading delimiters, and
+/// returns a null terminated copy of it allocated from the arena. On return p
+/// points just past the token. Returns NULL if there are no more tokens or the
+/// arena is full. (IntToAscii() and FloatToAscii() in RTL_Conversions.h format
+/// numbers into an arena in the same way.)
+//******************************************************************************
+char* AsciiToToken(const char*& p, Arena& arena, const char* delimiters=" \t\r\n");
+
+#endif
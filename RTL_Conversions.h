@@ -2,6 +2,7 @@
 #define _RTL_Conversions_h_
 
 #include <stdlib.h>
+#include "RTL_Arena.h"
 
 
 template <typename T> bool AsciiToInt(char*& p, T& value)
@@ -63,4 +64,49 @@ bool AsciiToFloat(char*& p, float& value)
     return success;
 }
 
+
+//******************************************************************************
+/// Formats a number as a null terminated string allocated from an arena (see
+/// RTL_Arena.h), so that it takes only as many bytes as the text needs rather
+/// than a worst-case char[]. Integers are written in the given base and floats
+/// with the given number of decimal places, as by Print. Returns NULL, leaving
+/// the arena as it was, if there is not enough space left.
+//******************************************************************************
+inline const char* ArenaText(Arena& arena, Arena::Marker mark, const ArenaPrint& text)
+{
+    if (!text.Overflow()) return text.c_str();
+
+    arena.Reset(mark);
+
+    return NULL;
+}
+
+
+template <typename T> const char* IntToAscii(T value, Arena& arena, uint8_t base=10)
+{
+    static_assert(sizeof(T) <= sizeof(long), "IntToAscii() formats at most a long");
+
+    Arena::Marker mark = arena.Mark();
+    ArenaPrint text(arena);
+
+    // Widened, so that char types are formatted as numbers too
+    if (T(-1) < T(0))
+        text.print(long(value), base);
+    else
+        text.print((unsigned long)value, base);
+
+    return ArenaText(arena, mark, text);
+}
+
+
+inline const char* FloatToAscii(float value, Arena& arena, uint8_t digits=2)
+{
+    Arena::Marker mark = arena.Mark();
+    ArenaPrint text(arena);
+
+    text.print(value, digits);
+
+    return ArenaText(arena, mark, text);
+}
+
 #endif
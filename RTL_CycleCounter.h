@@ -0,0 +1,56 @@
+#pragma once
+#ifndef _RTL_CycleCounter_h_
+#define _RTL_CycleCounter_h_
+/*******************************************************************************
+ * Header file for CPU cycle count support (for profiling).
+ *******************************************************************************/
+#include <inttypes.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+
+//******************************************************************************
+/// Returns a free-running count of CPU clock cycles, for measuring how long a
+/// piece of code takes:
+///
+///     uint32_t start = CycleCount();
+///     ...
+///     uint32_t cycles = CycleCount() - start;
+///
+/// On Cortex-M3/M4/M7 parts this reads the DWT cycle counter, which is exact
+/// (call EnableCycleCounter() once at startup). Everywhere else (AVR, Cortex-M0)
+/// there is no cycle counter, so it is derived from micros() and has that
+/// function's resolution (4 µs on a 16 MHz AVR).
+//******************************************************************************
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+
+#define RTL_HAS_CYCLE_COUNTER 1
+
+inline void EnableCycleCounter()
+{
+    volatile uint32_t* DEMCR    = reinterpret_cast<volatile uint32_t*>(0xE000EDFC);
+    volatile uint32_t* DWT_CTRL = reinterpret_cast<volatile uint32_t*>(0xE0001000);
+
+    *DEMCR |= 0x01000000;           // TRCENA: enable the DWT unit
+    *DWT_CTRL |= 0x00000001;        // CYCCNTENA: start the cycle counter
+}
+
+inline uint32_t CycleCount() { return *reinterpret_cast<volatile uint32_t*>(0xE0001004); }
+
+#else
+
+#define RTL_HAS_CYCLE_COUNTER 0
+
+inline void EnableCycleCounter() { }
+
+#if defined(F_CPU)
+inline uint32_t CycleCount() { return micros() * (F_CPU / 1000000UL); }
+#else
+inline uint32_t CycleCount() { return micros(); }
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+#pragma once
+#ifndef _RTL_Debounce_h_
+#define _RTL_Debounce_h_
+/*******************************************************************************
+ * Header file for the Debouncer (bit-sliced switch debouncer) template class.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Lock.h"
+
+
+//******************************************************************************
+/// Debounces _inputs digital inputs (switches, buttons, contacts) at once.
+///
+/// Rather than keeping a separate counter for each input, the counters are
+/// "vertical": bit n of _count0 and bit n of _count1 together form the 2-bit
+/// counter for input n. So one Word's worth of inputs (32 with the default
+/// uint32_t) is debounced by a handful of bitwise operations per sample, and
+/// the cost of Update() depends only on the number of words, not on how many
+/// of the inputs are changing.
+///
+/// An input's debounced state changes when its raw value has differed from
+/// the debounced state for 4 consecutive samples; any sample that agrees with
+/// the debounced state resets its counter. So with Update() called from a 5ms
+/// timer interrupt, an input must be stable for 20ms to register a change.
+///
+/// Inputs are packed into words with input n at bit (n % WordBits) of word
+/// (n / WordBits). A set bit means the input is active, so invert active-low
+/// inputs before passing them in (e.g. ~PIND).
+///
+///     Debouncer<64> keys;
+///
+///     ISR(TIMER2_COMPA_vect) { keys.Update(samples); }  // uint32_t samples[2]
+///
+///     uint32_t pressed = keys.TakePressed(0);           // in loop()
+///
+/// Update() and the Take...() methods are protected by LockPolicy (see
+/// RTL_Lock.h), so with the default InterruptLock Update() can be called from
+/// a timer ISR while loop() collects the pressed and released masks. Each edge
+/// is reported once: the Take...() methods return the edges accumulated since
+/// the last call and clear them.
+//******************************************************************************
+template <size_t _inputs, typename Word=uint32_t, typename LockPolicy=DefaultLock>
+class Debouncer : private LockPolicy
+{
+    static_assert(_inputs > 0, "Debouncer must have at least 1 input");
+
+    public: static const uint8_t WordBits = 8 * sizeof(Word);
+    public: static const size_t Words = (_inputs + WordBits - 1) / WordBits;
+
+
+    public: Debouncer() { Reset(); };
+
+
+    //**************************************************************************
+    /// Sets the debounced state of all inputs (to zero if state is NULL) and
+    /// discards any pending edges. Pass the current raw inputs as the state to
+    /// avoid reporting spurious edges at startup.
+    //**************************************************************************
+    public: void Reset(const Word* state=NULL)
+    {
+        Guard guard(*this);
+
+        for (size_t i = 0; i < Words; i++)
+        {
+            _state[i] = (state != NULL) ? state[i] : 0;
+            _count0[i] = 0;
+            _count1[i] = 0;
+            _pressed[i] = 0;
+            _released[i] = 0;
+        }
+    }
+
+
+    //**************************************************************************
+    /// Processes one sample of all of the inputs, given as Words words.
+    //**************************************************************************
+    public: void Update(const Word* samples)
+    {
+        Guard guard(*this);
+
+        for (size_t i = 0; i < Words; i++) UpdateWord(i, samples[i]);
+    }
+
+
+    //**************************************************************************
+    /// Processes one sample of the inputs in one word, for inputs that are read
+    /// a port at a time.
+    //**************************************************************************
+    public: void Update(size_t word, Word sample)
+    {
+        Guard guard(*this);
+
+        UpdateWord(word, sample);
+    }
+
+
+    //**************************************************************************
+    /// Return the inputs in a word that have become active (TakePressed()),
+    /// inactive (TakeReleased()) or either (TakeChanged()) since the last call,
+    /// and clear them. TakeChanged() clears both the pressed and released edges.
+    //**************************************************************************
+    public: Word TakePressed(size_t word)
+    {
+        Guard guard(*this);
+
+        Word edges = _pressed[word];
+
+        _pressed[word] = 0;
+
+        return edges;
+    }
+
+
+    public: Word TakeReleased(size_t word)
+    {
+        Guard guard(*this);
+
+        Word edges = _released[word];
+
+        _released[word] = 0;
+
+        return edges;
+    }
+
+
+    public: Word TakeChanged(size_t word)
+    {
+        Guard guard(*this);
+
+        Word edges = _pressed[word] | _released[word];
+
+        _pressed[word] = 0;
+        _released[word] = 0;
+
+        return edges;
+    }
+
+
+    //**************************************************************************
+    /// Copies the pressed and released edges of all of the inputs into arrays
+    /// of Words words, and clears them. Returns true if there were any edges.
+    //**************************************************************************
+    public: bool TakeEdges(Word* pressed, Word* released)
+    {
+        Guard guard(*this);
+
+        Word any = 0;
+
+        for (size_t i = 0; i < Words; i++)
+        {
+            pressed[i] = _pressed[i];
+            released[i] = _released[i];
+            any |= _pressed[i] | _released[i];
+            _pressed[i] = 0;
+            _released[i] = 0;
+        }
+
+        return (any != 0);
+    }
+
+
+    // The debounced state of the inputs in a word
+    public: inline Word State(size_t word) { Guard guard(*this); return _state[word]; };
+
+
+    // The debounced state of one input
+    public: inline bool IsActive(size_t input)
+    {
+        return (State(input / WordBits) & (Word(1) << (input % WordBits))) != 0;
+    };
+
+
+    public: static constexpr size_t Inputs() { return _inputs; };
+
+
+    private: typedef typename LockPolicy::Guard Guard;
+
+
+    // Advances the vertical counters of the inputs in one word. The counter of
+    // an input that differs from its debounced state counts 0, 1, 2, 3 and wraps
+    // back to 0 on the 4th sample, at which point the input toggles. The
+    // counter of an input that agrees with its debounced state is held at 0.
+    private: inline void UpdateWord(size_t i, Word sample)
+    {
+        Word delta = sample ^ _state[i];
+
+        _count1[i] = (_count1[i] ^ _count0[i]) & delta;
+        _count0[i] = ~_count0[i] & delta;
+
+        Word toggle = delta & ~(_count0[i] | _count1[i]);
+
+        _state[i] ^= toggle;
+        _pressed[i] |= toggle & _state[i];
+        _released[i] |= toggle & ~_state[i];
+    }
+
+
+    private: Word _state[Words];
+    private: Word _count0[Words];
+    private: Word _count1[Words];
+    private: Word _pressed[Words];
+    private: Word _released[Words];
+};
+
+#endif
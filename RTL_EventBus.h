@@ -0,0 +1,236 @@
+#pragma once
+#ifndef _RTL_EventBus_h_
+#define _RTL_EventBus_h_
+/*******************************************************************************
+ * Header file for the EventBus (publish/subscribe) template class.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Queue.h"
+
+
+//******************************************************************************
+/// A static publish/subscribe event bus. Modules subscribe handlers to topics,
+/// and events published to a topic are delivered to every handler subscribed
+/// to it, so publishers and subscribers do not need to know about each other.
+///
+/// Topics are small integers (typically the values of an enum) below _topics.
+/// Each topic has a subscriber table with room for _subscribers handlers, and
+/// the bus has a queue of _queue_size pending events. All of this is sized at
+/// compile time and nothing is allocated from the heap:
+///
+///     enum Topic : uint8_t { ButtonPressed, BatteryLow, TopicCount };
+///
+///     EventBus<Event, TopicCount> bus;
+///
+///     bus.Subscribe(BatteryLow, OnBatteryLow);        // in setup()
+///     bus.Publish(BatteryLow, event);                 // anywhere, including ISRs
+///     bus.Dispatch();                                 // in loop()
+///
+/// Publish() only queues the event, so it is interrupt-safe and quick. Handlers
+/// are called from Dispatch(), which removes pending events from the queue in
+/// batches of _batch_size (taking the queue lock once per batch) and calls the
+/// handlers with no lock held.
+///
+/// Subscribe() and Unsubscribe() must be called from the same context as
+/// Dispatch() (i.e. not from an ISR). A handler may publish events (they are
+/// delivered by the next Dispatch()), but should not subscribe or unsubscribe
+/// handlers of the topic it is handling.
+///
+/// Events are copied into the queue and moved out of it, so T should be a small
+/// value type; it must be default-constructible. LockPolicy (see RTL_Lock.h)
+/// protects the event queue and the count of dropped events; use NoLock if
+/// events are never published from an ISR (or another thread).
+//******************************************************************************
+template <typename T, uint8_t _topics, uint8_t _subscribers=4, size_t _queue_size=16, uint8_t _batch_size=4, typename LockPolicy=DefaultLock>
+class EventBus : private LockPolicy
+{
+    static_assert(_topics > 0, "EventBus must have at least 1 topic");
+    static_assert(_subscribers > 0, "EventBus must allow at least 1 subscriber per topic");
+    static_assert(_batch_size > 0, "EventBus batch size must be at least 1");
+
+    public: typedef void (*Handler)(uint8_t topic, const T& event, void* context);
+
+
+    public: EventBus() : _dropped(0)
+    {
+        for (uint8_t i = 0; i < _topics; i++) _subscriberCount[i] = 0;
+    };
+
+
+    //**************************************************************************
+    /// Subscribes a handler to a topic. The context pointer is passed to the
+    /// handler with each event. Returns false if the topic is invalid or its
+    /// subscriber table is full.
+    //**************************************************************************
+    public: bool Subscribe(uint8_t topic, Handler handler, void* context=NULL)
+    {
+        if (topic >= _topics || handler == NULL) return false;
+
+        uint8_t& count = _subscriberCount[topic];
+
+        if (count == _subscribers) return false;
+
+        _subscriberTable[topic][count].Handler = handler;
+        _subscriberTable[topic][count].Context = context;
+        count++;
+
+        return true;
+    }
+
+
+    //**************************************************************************
+    /// Removes a handler (with the same context) from a topic. Returns false if
+    /// it was not subscribed.
+    //**************************************************************************
+    public: bool Unsubscribe(uint8_t topic, Handler handler, void* context=NULL)
+    {
+        if (topic >= _topics) return false;
+
+        Subscriber* table = _subscriberTable[topic];
+        uint8_t& count = _subscriberCount[topic];
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (table[i].Handler == handler && table[i].Context == context)
+            {
+                MoveN(&table[i], &table[i + 1], count - i - 1);
+                count--;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    //**************************************************************************
+    /// Queues an event for delivery to the subscribers of a topic by the next
+    /// Dispatch(). Returns false (and counts the event as dropped) if the topic
+    /// is invalid or the queue is full.
+    //**************************************************************************
+    public: bool Publish(uint8_t topic, const T& event)
+    {
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
+
+        if (topic < _topics && _queue.Emplace(topic, event)) return true;
+
+        if (_dropped != 0xFFFF) _dropped++;
+
+        return false;                   // ATOMIC BLOCK END
+    }
+
+
+    //**************************************************************************
+    /// Compile-time checked versions of Subscribe() and Publish().
+    //**************************************************************************
+    public: template <uint8_t _topic> inline bool Subscribe(Handler handler, void* context=NULL)
+    {
+        static_assert(_topic < _topics, "Invalid EventBus topic");
+
+        return Subscribe(_topic, handler, context);
+    }
+
+
+    public: template <uint8_t _topic> inline bool Publish(const T& event)
+    {
+        static_assert(_topic < _topics, "Invalid EventBus topic");
+
+        return Publish(_topic, event);
+    }
+
+
+    //**************************************************************************
+    /// Delivers the events that are pending when it is called to their
+    /// subscribers, oldest first, and returns the number of events delivered.
+    /// Events published while Dispatch() is running (e.g. by the handlers) are
+    /// left for the next call, so Dispatch() always returns promptly. At most
+    /// maxEvents events are delivered.
+    //**************************************************************************
+    public: size_t Dispatch(size_t maxEvents=_queue_size)
+    {
+        // Return without taking the lock when there is nothing to do, where
+        // the lock policy allows that (see RTL_Lock.h)
+        if (LockPolicy::UnlockedPeek && _queue.IsEmpty()) return 0;
+
+        Message batch[_batch_size];
+        size_t pending = Pending();
+        size_t dispatched = 0;
+
+        if (maxEvents > pending) maxEvents = pending;
+
+        while (dispatched < maxEvents)
+        {
+            size_t wanted = maxEvents - dispatched;
+            size_t count;
+
+            {
+                Guard guard(*this);     // ATOMIC BLOCK BEGIN
+
+                count = _queue.Remove(batch, typename MessageQueue::Index((wanted < _batch_size) ? wanted : _batch_size));
+            }                           // ATOMIC BLOCK END
+
+            if (count == 0) break;
+
+            for (size_t i = 0; i < count; i++) Deliver(batch[i]);
+
+            dispatched += count;
+        }
+
+        return dispatched;
+    }
+
+
+    public: inline uint8_t Subscribers(uint8_t topic) const { return (topic < _topics) ? _subscriberCount[topic] : 0; };
+
+
+    public: inline size_t Pending() { Guard guard(*this); return _queue.Count(); };
+
+
+    // The number of events that could not be published because the queue was full
+    public: inline uint16_t Dropped() { Guard guard(*this); return _dropped; };
+
+
+    private: struct Message
+    {
+        Message() { };
+
+        Message(uint8_t topic, const T& event) : Topic(topic), Event(event) { };
+
+        uint8_t Topic;
+        T Event;
+    };
+
+
+    private: struct Subscriber
+    {
+        EventBus::Handler Handler;
+        void* Context;
+    };
+
+
+    // The queue is only used under the bus's own lock, which also guards
+    // _dropped, so it needs no lock of its own
+    private: typedef Queue<Message, _queue_size, NoLock> MessageQueue;
+
+    private: typedef typename LockPolicy::Guard Guard;
+
+
+    private: void Deliver(const Message& message)
+    {
+        const Subscriber* table = _subscriberTable[message.Topic];
+        uint8_t count = _subscriberCount[message.Topic];
+
+        for (uint8_t i = 0; i < count; i++) table[i].Handler(message.Topic, message.Event, table[i].Context);
+    }
+
+
+    private: MessageQueue _queue;
+    private: Subscriber _subscriberTable[_topics][_subscribers];
+    private: uint8_t _subscriberCount[_topics];
+    private: uint16_t _dropped;
+};
+
+#endif
@@ -0,0 +1,285 @@
+#pragma once
+#ifndef _RTL_Filters_h_
+#define _RTL_Filters_h_
+/*******************************************************************************
+ * Header file for fixed-size digital filter templates: moving average, biquad
+ * IIR cascade, and FIR.
+ *
+ * All filters are templated on the sample type T, which may be float or an
+ * integer type holding fixed-point values. For fixed-point filters, specify a
+ * wider accumulator type Acc (e.g. int32_t for int16_t samples) and the number
+ * of fractional bits in the coefficients, FracBits; products are summed in the
+ * accumulator and shifted right by FracBits to produce the output. For floating
+ * point filters leave Acc = T and FracBits = 0.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+
+//******************************************************************************
+/// Scales an accumulated sum of products back to the sample scale. Floating
+/// point values need no scaling; fixed-point values are shifted right.
+//******************************************************************************
+inline float  FilterScale(float acc, uint8_t)  { return acc; }
+inline double FilterScale(double acc, uint8_t) { return acc; }
+template <typename Acc> inline Acc FilterScale(Acc acc, uint8_t fracBits) { return acc >> fracBits; }
+
+
+//******************************************************************************
+/// The default MovingAverage accumulator for each sample type: wide enough to
+/// sum 65535 integer samples without overflow, and T itself for floating point.
+//******************************************************************************
+template <typename T> struct FilterAccumulator { typedef T Type; };
+
+template <> struct FilterAccumulator<char>     { typedef int32_t  Type; };
+template <> struct FilterAccumulator<int8_t>   { typedef int32_t  Type; };
+template <> struct FilterAccumulator<uint8_t>  { typedef uint32_t Type; };
+template <> struct FilterAccumulator<int16_t>  { typedef int32_t  Type; };
+template <> struct FilterAccumulator<uint16_t> { typedef uint32_t Type; };
+template <> struct FilterAccumulator<int32_t>  { typedef int64_t  Type; };
+template <> struct FilterAccumulator<uint32_t> { typedef uint64_t Type; };
+
+
+//******************************************************************************
+/// A moving average over the last _length samples.
+///
+/// This replaces the SHIFT_ARRAY_LEFT-and-sum approach: samples are kept in a
+/// circular buffer and a running sum is updated as each sample enters and the
+/// oldest one leaves, so an update is O(1) regardless of the window length.
+/// Until the window has filled, the average is over the samples seen so far.
+///
+/// The running sum is kept in Acc, which defaults to a wider type for integer
+/// samples (see FilterAccumulator) so that it cannot overflow.
+///
+/// With an integer accumulator the running sum is exact. With a floating point
+/// accumulator, rounding errors in the running sum accumulate over a very large
+/// number of samples; call Reset() occasionally if that matters.
+//******************************************************************************
+template <typename T, uint16_t _length, typename Acc=typename FilterAccumulator<T>::Type> class MovingAverage
+{
+    static_assert(_length > 0, "MovingAverage length must be at least 1");
+
+    public: MovingAverage() { Reset(); };
+
+    public: void Reset()
+    {
+        for (uint16_t i = 0; i < _length; i++) _window[i] = 0;
+
+        _index = 0;
+        _count = 0;
+        _sum = 0;
+    };
+
+    public: T Update(T sample)
+    {
+        _sum += Acc(sample) - Acc(_window[_index]);
+        _window[_index] = sample;
+
+        if (++_index == _length) _index = 0;
+        if (_count < _length) _count++;
+
+        return Value();
+    };
+
+    public: inline T Value() const
+    {
+        return (_count == _length) ? T(_sum / Acc(_length)) : (_count > 0) ? T(_sum / Acc(_count)) : T(0);
+    };
+
+    public: inline Acc Sum() const { return _sum; };
+
+    public: inline bool IsFull() const { return (_count == _length); };
+
+    public: void Process(const T* in, T* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) out[i] = Update(in[i]);
+    };
+
+    private: T _window[_length];
+    private: uint16_t _index;
+    private: uint16_t _count;
+    private: Acc _sum;
+};
+
+
+//******************************************************************************
+/// Coefficients for one second-order section, normalized so that a0 = 1:
+///
+///     y[n] = b0·x[n] + b1·x[n-1] + b2·x[n-2] - a1·y[n-1] - a2·y[n-2]
+//******************************************************************************
+template <typename T> struct BiquadCoefficients
+{
+    T b0;
+    T b1;
+    T b2;
+    T a1;
+    T a2;
+};
+
+
+//******************************************************************************
+/// A cascade of _stages biquad (second-order IIR) sections.
+///
+/// The sections use the Direct Form I structure, which keeps the input and output
+/// history at sample scale. That makes it suitable for fixed-point as well as
+/// floating point samples, since only the accumulator needs the extra headroom.
+//******************************************************************************
+template <typename T, uint8_t _stages=1, typename Acc=T, uint8_t _fracBits=0> class BiquadCascade
+{
+    public: BiquadCascade(const BiquadCoefficients<T>* coefficients)
+    {
+        for (uint8_t i = 0; i < _stages; i++) _coefficients[i] = coefficients[i];
+
+        Reset();
+    };
+
+    public: void Reset()
+    {
+        for (uint8_t i = 0; i < _stages; i++)
+        {
+            _state[i].x1 = _state[i].x2 = 0;
+            _state[i].y1 = _state[i].y2 = 0;
+        }
+    };
+
+    public: T Update(T x)
+    {
+        for (uint8_t i = 0; i < _stages; i++)
+        {
+            const BiquadCoefficients<T>& c = _coefficients[i];
+            State& s = _state[i];
+
+            Acc acc = Acc(c.b0) * x + Acc(c.b1) * s.x1 + Acc(c.b2) * s.x2 - Acc(c.a1) * s.y1 - Acc(c.a2) * s.y2;
+            T y = T(FilterScale(acc, _fracBits));
+
+            s.x2 = s.x1;
+            s.x1 = x;
+            s.y2 = s.y1;
+            s.y1 = y;
+            x = y;
+        }
+
+        return x;
+    };
+
+    public: void Process(const T* in, T* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) out[i] = Update(in[i]);
+    };
+
+    private: struct State { T x1, x2, y1, y2; };
+
+    private: BiquadCoefficients<T> _coefficients[_stages];
+    private: State _state[_stages];
+};
+
+
+//******************************************************************************
+/// A finite impulse response filter with _taps coefficients:
+///
+///     y[n] = h[0]·x[n] + h[1]·x[n-1] + ... + h[taps-1]·x[n-taps+1]
+///
+/// The sample history is a circular buffer stored twice over (each sample is
+/// written at i and i + taps), so the most recent taps samples are always
+/// contiguous. The convolution is then a straight dot product with no index
+/// wrapping, which the compiler can unroll and (on the host) vectorize.
+///
+/// Process() filters a block of at least _taps samples by convolving directly
+/// over the input buffer, so only the first _taps - 1 outputs read the history.
+//******************************************************************************
+template <typename T, uint16_t _taps, typename Acc=T, uint8_t _fracBits=0> class FIR
+{
+    static_assert(_taps > 0, "FIR must have at least 1 tap");
+
+    public: FIR(const T* coefficients)
+    {
+        for (uint16_t i = 0; i < _taps; i++) _h[i] = coefficients[i];
+
+        Reset();
+    };
+
+    public: void Reset()
+    {
+        for (uint16_t i = 0; i < 2 * _taps; i++) _history[i] = 0;
+
+        _index = 0;
+    };
+
+    public: T Update(T x)
+    {
+        _index = ((_index == 0) ? _taps : _index) - 1;
+        _history[_index] = _history[_index + _taps] = x;
+
+        return Convolve(&_history[_index]);
+    };
+
+    //**************************************************************************
+    /// Filters a block of samples. The arrays may be the same.
+    //**************************************************************************
+    public: void Process(const T* in, T* out, size_t count)
+    {
+        if (count < _taps)
+        {
+            for (size_t i = 0; i < count; i++) out[i] = Update(in[i]);
+
+            return;
+        }
+
+        // Move the previous history (newest first) to the upper half of the
+        // buffer and save the newest _taps inputs (newest first) in the lower
+        // half, before any output can overwrite them.
+        T* previous = &_history[_taps];
+
+        memmove(previous, &_history[_index], _taps * sizeof(T));
+
+        for (uint16_t k = 0; k < _taps; k++) _history[k] = in[count - 1 - k];
+
+        // The outputs are computed last to first, so that each one can replace
+        // its own input: an output only reads the inputs at or before it. From
+        // output _taps - 1 on, all the taps fall within the block.
+        for (size_t i = count; i-- > size_t(_taps - 1); ) out[i] = ConvolveBackward(&in[i]);
+
+        // The first _taps - 1 outputs also reach back into the previous history
+        for (uint16_t i = _taps - 1; i-- > 0; )
+        {
+            Acc acc = 0;
+
+            for (uint16_t k = 0; k <= i; k++) acc += Acc(_h[k]) * in[i - k];
+            for (uint16_t k = i + 1; k < _taps; k++) acc += Acc(_h[k]) * previous[k - i - 1];
+
+            out[i] = T(FilterScale(acc, _fracBits));
+        }
+
+        // Restore the doubled layout Update() expects, with the newest sample at 0
+        for (uint16_t k = 0; k < _taps; k++) previous[k] = _history[k];
+
+        _index = 0;
+    };
+
+    // Newest sample first
+    private: inline T Convolve(const T* x) const
+    {
+        Acc acc = 0;
+
+        for (uint16_t k = 0; k < _taps; k++) acc += Acc(_h[k]) * x[k];
+
+        return T(FilterScale(acc, _fracBits));
+    };
+
+    // Newest sample last, at x
+    private: inline T ConvolveBackward(const T* x) const
+    {
+        Acc acc = 0;
+
+        for (uint16_t k = 0; k < _taps; k++) acc += Acc(_h[k]) * *(x - k);
+
+        return T(FilterScale(acc, _fracBits));
+    };
+
+    private: T _h[_taps];
+    private: T _history[2 * _taps];
+    private: uint16_t _index;
+};
+
+#endif
@@ -0,0 +1,295 @@
+#pragma once
+#ifndef _RTL_FixedMap_h_
+#define _RTL_FixedMap_h_
+/*******************************************************************************
+ * Header file for the FixedMap (fixed-capacity hash map) template class and
+ * the hash functions it can use.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Lock.h"
+
+
+//******************************************************************************
+/// Hashes the bytes of a key with 32-bit FNV-1a. Works for any key type whose
+/// bytes are its value (integers, enums, plain structs without padding).
+//******************************************************************************
+template <typename K> struct FNV1aHash
+{
+    inline uint32_t operator()(const K& key) const
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&key);
+        uint32_t h = 2166136261UL;
+
+        for (size_t i = 0; i < sizeof(K); i++) h = (h ^ p[i]) * 16777619UL;
+
+        return h;
+    };
+};
+
+
+//******************************************************************************
+/// Hashes an integer key by Fibonacci (multiplicative) hashing. This is cheaper
+/// than FNV1aHash and spreads runs of consecutive IDs evenly over the table.
+///
+/// The hash is the product itself: its high bits depend on every bit of the
+/// key, and FixedMap takes its slot from the high bits (see FixedMap).
+//******************************************************************************
+template <typename K> struct FibonacciHash
+{
+    static_assert(sizeof(K) <= 4, "FibonacciHash keys must be at most 32 bits");
+
+    inline uint32_t operator()(const K& key) const { return uint32_t(key) * 2654435769UL; };
+};
+
+
+//******************************************************************************
+/// The hash FixedMap uses unless another is specified: FibonacciHash for integer
+/// keys and FNV1aHash for everything else.
+//******************************************************************************
+template <typename K> struct DefaultHash : public FNV1aHash<K> { };
+
+template <> struct DefaultHash<char>     : public FibonacciHash<char> { };
+template <> struct DefaultHash<int8_t>   : public FibonacciHash<int8_t> { };
+template <> struct DefaultHash<uint8_t>  : public FibonacciHash<uint8_t> { };
+template <> struct DefaultHash<int16_t>  : public FibonacciHash<int16_t> { };
+template <> struct DefaultHash<uint16_t> : public FibonacciHash<uint16_t> { };
+template <> struct DefaultHash<int32_t>  : public FibonacciHash<int32_t> { };
+template <> struct DefaultHash<uint32_t> : public FibonacciHash<uint32_t> { };
+
+
+//******************************************************************************
+/// A hash map with room for _capacity entries, all stored statically within the
+/// map (nothing is allocated from the heap).
+///
+/// Entries are kept in an open-addressed table with linear probing. The table
+/// has at least a quarter more slots than _capacity (rounded up to a power of
+/// two), so even a full map keeps probe sequences short. Removal uses backward
+/// shift deletion: the entries following the removed one in its probe run are
+/// moved back to fill the hole, so there are no tombstones and lookups do not
+/// slow down as entries come and go.
+///
+/// The Hash functor (see DefaultHash) maps a key to a uint32_t, and the slot a
+/// key starts probing from is the top log2(Slots) bits of its hash. The high
+/// bits of a multiplicative hash are the well-mixed ones, and a hash that mixes
+/// all its bits (such as FNV1aHash) works either way. Keys are compared with
+/// operator==.
+///
+/// Get(), Set(), Remove() and Contains() are protected by LockPolicy (see
+/// RTL_Lock.h), so with the default InterruptLock a map updated in loop() can
+/// be read from an ISR (or vice versa). Find() returns a pointer into the table
+/// without any locking and is meant for single-context use.
+//******************************************************************************
+template <typename K, typename V, size_t _capacity, typename Hash=DefaultHash<K>, typename LockPolicy=DefaultLock>
+class FixedMap : private LockPolicy
+{
+    static_assert(_capacity > 0, "FixedMap capacity must be at least 1");
+
+    public: static const size_t Slots = NextPowerOfTwo(_capacity + _capacity / 4 + 1);
+
+    public: typedef typename IndexType<Slots>::Type Index;
+
+    private: static const uint8_t SlotBits = Log2(Slots);
+
+
+    public: FixedMap() : _count(0)
+    {
+        for (size_t i = 0; i < sizeof(_occupied); i++) _occupied[i] = 0;
+    };
+
+
+    public: ~FixedMap() { Clear(); };
+
+
+    private: FixedMap(const FixedMap&) = delete;
+    private: FixedMap& operator=(const FixedMap&) = delete;
+
+
+    //**************************************************************************
+    /// Sets the value for a key, adding the key if it is not already in the map.
+    /// Returns false if the key is new and the map is full.
+    //**************************************************************************
+    public: bool Set(const K& key, const V& value)
+    {
+        Guard guard(*this);
+
+        Index i = Probe(key);
+
+        if (IsOccupied(i))
+        {
+            Slot(i)->Value = value;
+
+            return true;
+        }
+
+        if (_count == _capacity) return false;
+
+        new (Slot(i)) Entry(key, value);
+        SetOccupied(i, true);
+        _count++;
+
+        return true;
+    }
+
+
+    //**************************************************************************
+    /// Copies the value for a key into value. Returns false if the key is not in
+    /// the map.
+    //**************************************************************************
+    public: bool Get(const K& key, V& value)
+    {
+        Guard guard(*this);
+
+        Index i = Probe(key);
+
+        if (!IsOccupied(i)) return false;
+
+        value = Slot(i)->Value;
+
+        return true;
+    }
+
+
+    public: bool Contains(const K& key)
+    {
+        Guard guard(*this);
+
+        return IsOccupied(Probe(key));
+    }
+
+
+    //**************************************************************************
+    /// Returns a pointer to the value for a key, or NULL if the key is not in the
+    /// map. The pointer is valid until the map is next modified. No lock is
+    /// taken, so only use this when the map is not shared with an ISR.
+    //**************************************************************************
+    public: V* Find(const K& key)
+    {
+        Index i = Probe(key);
+
+        return IsOccupied(i) ? &Slot(i)->Value : NULL;
+    }
+
+
+    //**************************************************************************
+    /// Removes a key and its value. Returns false if the key is not in the map.
+    //**************************************************************************
+    public: bool Remove(const K& key)
+    {
+        Guard guard(*this);
+
+        Index hole = Probe(key);
+
+        if (!IsOccupied(hole)) return false;
+
+        Slot(hole)->~Entry();
+
+        // Move back any entry in the rest of the probe run that may not be
+        // placed after the hole, i.e. whose home slot is not cyclically within
+        // (hole, i]. Then the hole moves to where that entry was.
+        for (Index i = Next(hole); IsOccupied(i); i = Next(i))
+        {
+            Index home = Home(Slot(i)->Key);
+
+            bool stays = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+
+            if (!stays)
+            {
+                new (Slot(hole)) Entry(Move(*Slot(i)));
+                Slot(i)->~Entry();
+                hole = i;
+            }
+        }
+
+        SetOccupied(hole, false);
+        _count--;
+
+        return true;
+    }
+
+
+    public: void Clear()
+    {
+        Guard guard(*this);
+
+        for (Index i = 0; i < Slots; i++)
+        {
+            if (IsOccupied(i))
+            {
+                Slot(i)->~Entry();
+                SetOccupied(i, false);
+            }
+        }
+
+        _count = 0;
+    }
+
+
+    public: inline Index Count() { Guard guard(*this); return _count; };
+
+
+    public: inline bool IsEmpty() { return (Count() == 0); };
+
+
+    public: inline bool IsFull() { return (Count() == _capacity); };
+
+
+    public: static constexpr size_t Capacity() { return _capacity; };
+
+
+    private: struct Entry
+    {
+        Entry(const K& key, const V& value) : Key(key), Value(value) { };
+
+        Entry(Entry&& other) : Key(Move(other.Key)), Value(Move(other.Value)) { };
+
+        K Key;
+        V Value;
+    };
+
+
+    private: typedef typename LockPolicy::Guard Guard;
+
+
+    // Slots is at least 2, so the shift is at most 31
+    private: static inline Index Home(const K& key) { return Index(Hash()(key) >> (32 - SlotBits)); };
+
+
+    private: static inline Index Next(Index i) { return Index((i + 1) & (Slots - 1)); };
+
+
+    // Returns the slot holding key or, if key is not in the map, the empty slot
+    // that ends its probe run (where it would be inserted). The table always has
+    // empty slots since Slots > _capacity, so the loop always ends.
+    private: Index Probe(const K& key)
+    {
+        Index i = Home(key);
+
+        while (IsOccupied(i) && !(Slot(i)->Key == key)) i = Next(i);
+
+        return i;
+    }
+
+
+    private: inline bool IsOccupied(Index i) const { return (_occupied[i >> 3] & (1 << (i & 7))) != 0; };
+
+
+    private: inline void SetOccupied(Index i, bool occupied)
+    {
+        if (occupied)
+            _occupied[i >> 3] |= uint8_t(1 << (i & 7));
+        else
+            _occupied[i >> 3] &= uint8_t(~(1 << (i & 7)));
+    };
+
+
+    private: inline Entry* Slot(Index i) { return reinterpret_cast<Entry*>(_storage) + i; };
+
+
+    private: alignas(Entry) uint8_t _storage[sizeof(Entry) * Slots];
+    private: uint8_t _occupied[(Slots + 7) / 8];
+    private: Index _count;
+};
+
+#endif
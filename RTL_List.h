@@ -1,21 +1,67 @@
 /*******************************************************************************
-Header file for Queue template class.
+Header file for List template class.
 *******************************************************************************/
 #ifndef _RTL_List_h_
 #define _RTL_List_h_
 
 #include <inttypes.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Lock.h"
 
 
 struct IndexOutOfBoundsException { };
 
 
-template <typename T, int _list_size=10> class List
+//******************************************************************************
+/// A fixed-size, interrupt-safe list of items kept in insertion order.
+///
+/// The count uses the smallest unsigned type that can hold _list_size (see
+/// IndexType), so lists of up to 255 items keep a single-byte count.
+///
+/// LockPolicy (see RTL_Lock.h) determines how the list is protected against
+/// concurrent access. The default, InterruptLock, makes it safe to use between
+/// ISRs and loop(); a list only used from one context can use NoLock.
+//******************************************************************************
+template <typename T, size_t _list_size=10, typename LockPolicy=DefaultLock> class List : protected LockPolicy
 {
-    public: List() : _count(0) { };
+    static_assert(_list_size > 0, "List size must be at least 1");
 
+    public: typedef typename IndexType<_list_size>::Type Index;
 
-    public: bool Add(T item)
+    public: List() : _count(0), _notEmpty(0) { };
+
+
+    public: ~List()
+    {
+        for (Index i = 0; i < _count; i++) Slot(i)->~T();
+    }
+
+
+    // Lists are shared with ISRs through a fixed address, so they are not copied
+    private: List(const List&) = delete;
+    private: List& operator=(const List&) = delete;
+
+
+    //**************************************************************************
+    /// Appends a copy of an item to the end of the list. Returns false if the
+    /// list is full.
+    //**************************************************************************
+    public: inline bool Add(const T& item) { return Emplace(item); };
+
+
+    //**************************************************************************
+    /// Moves an item onto the end of the list without copying it.
+    //**************************************************************************
+    public: inline bool Add(T&& item) { return Emplace(Move(item)); };
+
+
+    //**************************************************************************
+    /// Constructs an item directly in place at the end of the list, forwarding
+    /// the arguments to T's constructor. Returns false (and constructs nothing)
+    /// if the list is full. The constructor runs while the lock is held, so it
+    /// should be short.
+    //**************************************************************************
+    public: template <typename... Args> bool Emplace(Args&&... args)
     {
         /*
         Interrupts MUST be disabled while an item is being added to ensure stability
@@ -40,23 +86,48 @@ template <typename T, int _list_size=10> class List
         Contrast this with the logic in the Remove() method.
         */
 
-        bool added = false;
+        Guard guard(*this); // ATOMIC BLOCK BEGIN
 
-        noInterrupts(); // ATOMIC BLOCK BEGIN
+        if (_count == _list_size) return false;
 
-        if (!IsFull())
-        {
-            _list[_count++] = item;
-            added = true;
-        }
+        new (Slot(_count)) T(Forward<Args>(args)...);
+        SetCount(_count + 1);
+
+        return true;        // ATOMIC BLOCK END
+    }
 
-        interrupts(); // ATOMIC BLOCK END
 
-        return added;
+    //**************************************************************************
+    /// Constructs an item in place at the specified index (0 to Count()), moving
+    /// the items from that index on up one position. Returns false if the list
+    /// is full or the index is out of range.
+    //**************************************************************************
+    public: template <typename... Args> bool Insert(int index, Args&&... args)
+    {
+        Guard guard(*this); // ATOMIC BLOCK BEGIN
+
+        if (_count == _list_size || index < 0 || size_t(index) > _count) return false;
+
+        InsertAt(Index(index), Forward<Args>(args)...);
+
+        return true;        // ATOMIC BLOCK END
     }
 
 
-    public: bool Remove(int index)
+    //**************************************************************************
+    /// Removes the item at the specified index. The items after it are moved
+    /// down one position. Returns false if the index is out of range.
+    //**************************************************************************
+    public: inline bool Remove(int index) { return Take(index, NULL); };
+
+
+    //**************************************************************************
+    /// Removes the item at the specified index, moving it into item.
+    //**************************************************************************
+    public: inline bool Remove(int index, T& item) { return Take(index, &item); };
+
+
+    private: bool Take(int index, T* item)
     {
         /*
         Interrupts MUST be disabled while an item is being removed to ensure
@@ -71,24 +142,20 @@ template <typename T, int _list_size=10> class List
         want interrupts turned off when we actually have an item to remove.
 
         Contrast this with the logic in the Add() method.
-        */
 
-        if (IsEmpty()) return false;
+        The early check reads the count without the lock, so it is only made where
+        that is safe (see RTL_Lock.h), and it is repeated once the lock is held.
+        */
 
-        bool removed = false;
+        if (LockPolicy::UnlockedPeek && !_notEmpty) return false;
 
-        noInterrupts(); // ATOMIC BLOCK BEGIN
+        Guard guard(*this); // ATOMIC BLOCK BEGIN
 
-        if (0 <= index && index < _count)
-        {
-            memcpy(&_list[index], &_list[index + 1], ((_count - index) - 1) * sizeof(*_list));
-            _count--;
-            removed = true;
-        }
+        if (index < 0 || size_t(index) >= _count) return false;
 
-        interrupts(); // ATOMIC BLOCK END
+        RemoveAt(Index(index), item);
 
-        return removed;
+        return true;        // ATOMIC BLOCK END
     }
 
 
@@ -96,9 +163,9 @@ template <typename T, int _list_size=10> class List
     {
         bool removed = false;
 
-        for (int i = 0; i < _count; i++)
+        for (int i = 0; i < Count(); i++)
         {
-            if (_list[i] == item)
+            if (*Slot(i) == item)
             {
                 removed = Remove(i);
                 break;
@@ -114,15 +181,15 @@ template <typename T, int _list_size=10> class List
         T item;
         bool found = false;
 
-        noInterrupts();     // ATOMIC BLOCK BEGIN
-
-        if (0 <= index && index < _count)
         {
-            item = _list[index];
-            found = true;
-        }
+            Guard guard(*this);     // ATOMIC BLOCK BEGIN
 
-        interrupts();       // ATOMIC BLOCK END
+            if (0 <= index && size_t(index) < _count)
+            {
+                item = *Slot(Index(index));
+                found = true;
+            }
+        }                           // ATOMIC BLOCK END
 
         if (!found) throw IndexOutOfBoundsException();
 
@@ -130,24 +197,103 @@ template <typename T, int _list_size=10> class List
     }
 
 
-    public: inline int Count() { return _count; };
+    //**************************************************************************
+    /// Returns the number of items in the list. The count is read under the
+    /// lock unless it is a single byte and the lock policy allows unlocked reads
+    /// (see RTL_Lock.h); a wider count could otherwise be read half-updated.
+    //**************************************************************************
+    public: inline int Count()
+    {
+        if (sizeof(Index) == 1 && LockPolicy::UnlockedPeek) return _count;
+
+        Guard guard(*this);
+
+        return _count;
+    };
+
+
+    public: inline bool IsFull() { return (Count() == int(_list_size)); };
+
+
+    public: inline bool IsEmpty() { return LockPolicy::UnlockedPeek ? !_notEmpty : (Count() == 0); };
+
 
+    public: static constexpr size_t Capacity() { return _list_size; };
 
-    public: inline bool IsFull() { return (_count == _list_size); };
 
+    public: inline T& operator[](size_t index) { return *Slot(index); };
 
-    public: inline bool IsEmpty() { return (_count == 0); };
 
+    public: inline const T& operator[](size_t index) const { return *Slot(index); };
 
-    public: inline T& operator[](size_t index) { return _list[index]; };
 
+    /***************************************************************************
+    Unlocked primitives for derived containers (e.g. SortedList), which must
+    hold the lock and check the index and count themselves
+    ***************************************************************************/
+    protected: typedef typename LockPolicy::Guard Guard;
+
+
+    // Opens a gap at index (< Count() < capacity) and constructs the item in it
+    protected: template <typename... Args> void InsertAt(Index index, Args&&... args)
+    {
+        OpenGap(index, BoolType<IsTriviallyCopyable<T>::value>());
+        new (Slot(index)) T(Forward<Args>(args)...);
+        SetCount(_count + 1);
+    }
+
+
+    // Removes the item at index (< Count()), optionally moving it into item
+    protected: void RemoveAt(Index index, T* item)
+    {
+        if (item != NULL) *item = Move(*Slot(index));
+
+        // Move the following items down over the removed one, then destroy the
+        // (now moved-from) last item. For trivially copyable types this is a
+        // single memmove and the destructor call compiles away.
+        MoveN(Slot(index), Slot(index + 1), (_count - index) - 1);
+        Slot(_count - 1)->~T();
+        SetCount(_count - 1);
+    }
 
-    public: inline const T& operator[](size_t index) const { return _list[index]; };
+
+    // Updates the count, and the single-byte copy of whether it is non-zero
+    // that Remove() and IsEmpty() read without the lock (so that lists of more
+    // than 255 items can be polled without it too)
+    protected: inline void SetCount(size_t count)
+    {
+        _count = Index(count);
+        _notEmpty = (count != 0);
+    }
+
+
+    protected: inline T* Slot(size_t index) { return reinterpret_cast<T*>(_storage) + index; };
+
+
+    protected: inline const T* Slot(size_t index) const { return reinterpret_cast<const T*>(_storage) + index; };
+
+
+    // Moves the items from index on up one slot, leaving slot index unconstructed
+    private: void OpenGap(Index index, BoolType<true>)
+    {
+        memmove(Slot(index + 1), Slot(index), (_count - index) * sizeof(T));
+    }
+
+
+    private: void OpenGap(Index index, BoolType<false>)
+    {
+        if (index == _count) return;
+
+        new (Slot(_count)) T(Move(*Slot(_count - 1)));
+        MoveN(Slot(index + 1), Slot(index), (_count - index) - 1);
+        Slot(index)->~T();
+    }
 
 
-    private: const int LIST_SIZE = _list_size;
-    private: T _list[_list_size];
-    private: uint8_t _count;
+    // Raw storage: only the first _count slots hold constructed items
+    private: alignas(T) uint8_t _storage[sizeof(T) * _list_size];
+    protected: Index _count;
+    private: volatile uint8_t _notEmpty;
 };
 
 #endif
@@ -0,0 +1,170 @@
+#pragma once
+#ifndef _RTL_Lock_h_
+#define _RTL_Lock_h_
+/*******************************************************************************
+ * Header file for the locking policies used by the fixed-size containers.
+ *
+ * A locking policy is a class with a nested Guard class. Constructing a Guard
+ * (from a reference to the policy object) enters a critical section, and the
+ * Guard's destructor leaves it:
+ *
+ *     {
+ *         InterruptLock::Guard guard(lock);    // Critical section begins
+ *         ...
+ *     }                                        // Critical section ends
+ *
+ * The containers (Queue, List, Pool, PriorityQueue) take the policy as a
+ * template parameter and inherit from it privately, so a policy that has no
+ * state (NoLock, InterruptLock) adds nothing to the size of the container.
+ *
+ * Each policy also has a constant, UnlockedPeek, which is true if a container
+ * may read a single-byte member without the lock (to return early from
+ * Remove() on an empty queue, say, without disabling interrupts). That is
+ * only safe when everything sharing the container runs on one core, so it is
+ * false for the host threading policies, where such a read is a data race.
+ *******************************************************************************/
+#include <inttypes.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+
+//******************************************************************************
+/// No locking at all. Use this for containers that are only ever accessed from
+/// one context (e.g. only from loop()), which then pay nothing for locking.
+//******************************************************************************
+class NoLock
+{
+    public: static const bool UnlockedPeek = true;
+
+    public: class Guard
+    {
+        public: inline Guard(NoLock&) { };
+
+        private: Guard(const Guard&) = delete;
+        private: Guard& operator=(const Guard&) = delete;
+    };
+};
+
+
+//******************************************************************************
+/// Disables interrupts for the duration of the critical section. The previous
+/// interrupt state is saved and restored (rather than interrupts being enabled
+/// unconditionally), so critical sections nest correctly and are safe to enter
+/// from an ISR or from code that has already disabled interrupts.
+///
+/// On targets where the interrupt state cannot be saved this falls back to
+/// noInterrupts()/interrupts(), which does not nest. Host builds have no
+/// interrupts, so there it does nothing.
+//******************************************************************************
+class InterruptLock
+{
+    public: static const bool UnlockedPeek = true;
+
+    public: class Guard
+    {
+#if defined(__AVR__)
+
+        public: inline Guard(InterruptLock&) : _state(SREG) { cli(); };
+
+        public: inline ~Guard() { SREG = _state; };
+
+        private: uint8_t _state;
+
+#elif defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_BASE__) || defined(__ARM_ARCH_8M_MAIN__)
+
+        public: inline Guard(InterruptLock&)
+        {
+            __asm__ volatile ("mrs %0, primask" : "=r" (_state));
+            __asm__ volatile ("cpsid i" : : : "memory");
+        };
+
+        public: inline ~Guard() { __asm__ volatile ("msr primask, %0" : : "r" (_state) : "memory"); };
+
+        private: uint32_t _state;
+
+#elif defined(ARDUINO)
+
+        public: inline Guard(InterruptLock&) { noInterrupts(); };
+
+        public: inline ~Guard() { interrupts(); };
+
+#else
+
+        public: inline Guard(InterruptLock&) { };
+
+#endif
+
+        private: Guard(const Guard&) = delete;
+        private: Guard& operator=(const Guard&) = delete;
+    };
+};
+
+
+#if !defined(ARDUINO)
+
+#include <mutex>
+
+//******************************************************************************
+/// A busy-waiting lock for host builds, for containers shared between threads
+/// where the critical sections are only a few instructions long.
+//******************************************************************************
+class SpinLock
+{
+    public: static const bool UnlockedPeek = false;
+
+    public: SpinLock() : _flag(false) { };
+
+    public: class Guard
+    {
+        public: inline Guard(SpinLock& lock) : _lock(lock)
+        {
+            while (__atomic_test_and_set(&_lock._flag, __ATOMIC_ACQUIRE)) { }
+        };
+
+        public: inline ~Guard() { __atomic_clear(&_lock._flag, __ATOMIC_RELEASE); };
+
+        private: Guard(const Guard&) = delete;
+        private: Guard& operator=(const Guard&) = delete;
+
+        private: SpinLock& _lock;
+    };
+
+    private: bool _flag;
+};
+
+
+//******************************************************************************
+/// A std::mutex based lock for host builds, for containers shared between
+/// threads that may hold the lock for longer (e.g. while constructing items).
+//******************************************************************************
+class MutexLock
+{
+    public: static const bool UnlockedPeek = false;
+
+    public: class Guard
+    {
+        public: inline Guard(MutexLock& lock) : _lock(lock) { _lock._mutex.lock(); };
+
+        public: inline ~Guard() { _lock._mutex.unlock(); };
+
+        private: Guard(const Guard&) = delete;
+        private: Guard& operator=(const Guard&) = delete;
+
+        private: MutexLock& _lock;
+    };
+
+    private: std::mutex _mutex;
+};
+
+#endif
+
+
+//******************************************************************************
+/// The locking policy used by the containers unless another one is specified.
+/// Containers are interrupt-safe by default.
+//******************************************************************************
+typedef InterruptLock DefaultLock;
+
+#endif
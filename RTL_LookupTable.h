@@ -0,0 +1,319 @@
+#pragma once
+#ifndef _RTL_LookupTable_h_
+#define _RTL_LookupTable_h_
+/*******************************************************************************
+ * Header file for piecewise-linear lookup tables (calibration curves).
+ *
+ * Two kinds of table are provided:
+ *
+ *  - LookupTable, for breakpoints at arbitrary (ascending) input values. The
+ *    segment containing an input is found by binary search.
+ *
+ *  - UniformLookupTable, for outputs sampled at evenly spaced inputs. The
+ *    segment is found directly by multiplying by a precomputed reciprocal of
+ *    the spacing, so evaluation is O(1) with no division.
+ *
+ * The table data is read with memcpy_P, so it can (and normally should) be
+ * stored in PROGMEM. Inputs outside the table are clamped to the first or last
+ * output value.
+ *
+ * If either In or Out is a floating point type, interpolation is done in float.
+ * Otherwise both are treated as integers (or fixed-point values of up to 32
+ * bits) and interpolation is done in integer arithmetic, with no floating point
+ * code at all. When both are 16 bits or less, LookupTable interpolates with
+ * 32-bit arithmetic only; wider types need a 64-bit division per evaluation,
+ * which is slow on 8-bit processors.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Math.h"
+
+
+//******************************************************************************
+/// One breakpoint of a LookupTable: output y at input x.
+//******************************************************************************
+template <typename In, typename Out> struct Breakpoint
+{
+    In x;
+    Out y;
+};
+
+
+//******************************************************************************
+/// A piecewise-linear function defined by _size breakpoints, in order of
+/// increasing input value:
+///
+///     const Breakpoint<int16_t, int16_t> ThermistorCurve[] PROGMEM = { ... };
+///
+///     LookupTable<int16_t, int16_t, 12> thermistor(ThermistorCurve);
+///
+///     int16_t t = thermistor.Evaluate(analogRead(A0));
+///
+/// Evaluate() is O(log n). The batch version of Evaluate() starts each search
+/// from the segment found for the previous input, so a stream of inputs that
+/// changes slowly is converted in close to O(1) per input.
+//******************************************************************************
+template <typename In, typename Out, size_t _size> class LookupTable
+{
+    static_assert(_size >= 2, "LookupTable must have at least 2 breakpoints");
+    static_assert(IsFloatingPoint<In>::value || IsFloatingPoint<Out>::value || (sizeof(In) <= 4 && sizeof(Out) <= 4),
+                  "Integer LookupTables support inputs and outputs of up to 32 bits");
+
+    public: typedef Breakpoint<In, Out> Point;
+
+    public: LookupTable(const Point* table) : _table(table) { };
+
+
+    public: Out Evaluate(In x) const { return Interpolate(Segment(x, 0), x); };
+
+
+    public: void Evaluate(const In* in, Out* out, size_t count) const
+    {
+        size_t segment = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            segment = Segment(in[i], segment);
+            out[i] = Interpolate(segment, in[i]);
+        }
+    };
+
+
+    private: inline In ReadX(size_t i) const
+    {
+        In x;
+
+        memcpy_P(&x, &_table[i].x, sizeof(In));
+
+        return x;
+    };
+
+
+    // Returns the index of the segment [x(i), x(i+1)) containing x, trying the
+    // hinted segment and the one after it before resorting to a binary search.
+    // Inputs beyond either end of the table map to the end segments.
+    private: size_t Segment(In x, size_t hint) const
+    {
+        if (ReadX(hint) <= x)
+        {
+            if (x < ReadX(hint + 1)) return hint;
+            if (hint + 2 < _size && x < ReadX(hint + 2)) return hint + 1;
+        }
+
+        size_t low = 0, high = _size - 1;
+
+        // Invariant: x(low) <= x < x(high), treating the ends as unbounded
+        while (high - low > 1)
+        {
+            size_t mid = low + (high - low) / 2;
+
+            if (ReadX(mid) <= x) low = mid; else high = mid;
+        }
+
+        return low;
+    };
+
+
+    private: Out Interpolate(size_t i, In x) const
+    {
+        Point p[2];
+
+        memcpy_P(p, &_table[i], sizeof(p));
+
+        if (x <= p[0].x) return p[0].y;
+        if (x >= p[1].x) return p[1].y;
+
+        return Interpolate(p[0], p[1], x, BoolType<IsFloatingPoint<In>::value || IsFloatingPoint<Out>::value>());
+    };
+
+
+    private: static inline Out Interpolate(const Point& p0, const Point& p1, In x, BoolType<true>)
+    {
+        return Out(lerp(float(p0.y), float(p1.y), float(x - p0.x) / float(p1.x - p0.x)));
+    };
+
+
+    private: static inline Out Interpolate(const Point& p0, const Point& p1, In x, BoolType<false>)
+    {
+        return InterpolateInteger(p0, p1, x, BoolType<(sizeof(In) <= 2 && sizeof(Out) <= 2)>());
+    };
+
+
+    // For inputs and outputs of up to 16 bits. The position within the segment
+    // is computed as a 16-bit fraction by a 32-bit division, rounded up so that
+    // exact results are not truncated to one less. The magnitude of the output
+    // change is scaled by the fraction as an unsigned 32-bit product, which
+    // cannot overflow since both factors are below 2^16.
+    private: static inline Out InterpolateInteger(const Point& p0, const Point& p1, In x, BoolType<true>)
+    {
+        uint32_t span = uint32_t(int32_t(p1.x) - int32_t(p0.x));
+        uint32_t fraction = ((uint32_t(int32_t(x) - int32_t(p0.x)) << 16) + span - 1) / span;
+        int32_t dy = int32_t(p1.y) - int32_t(p0.y);
+        uint32_t step = (uint32_t(dy < 0 ? -dy : dy) * fraction) >> 16;
+
+        return Out(int32_t(p0.y) + (dy < 0 ? -int32_t(step) : int32_t(step)));
+    };
+
+
+    // For 32-bit inputs or outputs. Each difference can be up to 2^32, so their
+    // product could overflow even 64 bits; instead the output change is divided
+    // by the span first and only the remainder (below the span) is multiplied.
+    private: static inline Out InterpolateInteger(const Point& p0, const Point& p1, In x, BoolType<false>)
+    {
+        uint64_t span = uint64_t(int64_t(p1.x) - int64_t(p0.x));
+        uint64_t dx = uint64_t(int64_t(x) - int64_t(p0.x));
+        int64_t dy = int64_t(p1.y) - int64_t(p0.y);
+        uint64_t magnitude = uint64_t(dy < 0 ? -dy : dy);
+        uint64_t step = (magnitude / span) * dx + (magnitude % span) * dx / span;
+
+        return Out(int64_t(p0.y) + (dy < 0 ? -int64_t(step) : int64_t(step)));
+    };
+
+
+    private: const Point* _table;
+};
+
+
+//******************************************************************************
+/// A piecewise-linear function defined by _size outputs at evenly spaced inputs
+/// from x0 to x1:
+///
+///     const float DacCorrection[33] PROGMEM = { ... };
+///
+///     UniformLookupTable<uint16_t, float, 33> correction(0, 4096, DacCorrection);
+///
+/// The reciprocal of the input spacing is computed once, by the constructor, so
+/// Evaluate() is just a subtraction, a multiply, two table reads and a lerp.
+/// For integer types the position in the table is computed in 32.32 fixed point
+/// and the fraction is passed to lerp_q16(). For inputs of up to 16 bits the
+/// scale is split into 16.16 and 16 further fraction bits, so that the same
+/// position is computed with two 32-bit multiplies instead of a 64-bit one.
+///
+/// x1 must be greater than x0. If it is not, IsValid() returns false and the
+/// table evaluates to its first output for every input up to x0 and to its
+/// last output otherwise.
+//******************************************************************************
+template <typename In, typename Out, size_t _size> class UniformLookupTable
+{
+    static_assert(_size >= 2, "UniformLookupTable must have at least 2 points");
+
+    private: static const bool UseFloat = IsFloatingPoint<In>::value || IsFloatingPoint<Out>::value;
+
+    // Whether the position fits 32 bits: the input offset is below 2^16 and
+    // the position below (_size - 1)·2^16
+    private: static const bool Narrow = (sizeof(In) <= 2 && _size <= 0x8000);
+
+    public: UniformLookupTable(In x0, In x1, const Out* y) : _x0(x0), _x1(x1), _y(y)
+    {
+        // An empty (or reversed) range has no spacing to divide by. Evaluate()
+        // never interpolates in that case, since every input is then <= x0 or
+        // >= x1.
+        if (!(x0 < x1))
+            _scale.q32 = 0;
+        else if (UseFloat)
+            _scale.f = float(_size - 1) / float(x1 - x0);
+        else
+        {
+            // Rounded up, so that inputs exactly on a breakpoint are not truncated into the previous segment
+            uint64_t range = uint64_t(int64_t(x1) - int64_t(x0));
+            uint64_t q32 = ((uint64_t(_size - 1) << 32) + range - 1) / range;
+
+            if (Narrow)
+            {
+                _scale.q16.whole = uint32_t(q32 >> 16);
+                _scale.q16.fraction = uint16_t(q32);
+            }
+            else
+                _scale.q32 = q32;
+        }
+    };
+
+
+    public: Out Evaluate(In x) const
+    {
+        if (x <= _x0) return ReadY(0);
+        if (x >= _x1) return ReadY(_size - 1);
+
+        return Interpolate(x, BoolType<UseFloat>(), BoolType<Narrow>());
+    };
+
+
+    public: void Evaluate(const In* in, Out* out, size_t count) const
+    {
+        for (size_t i = 0; i < count; i++) out[i] = Evaluate(in[i]);
+    };
+
+
+    public: inline bool IsValid() const { return (_x0 < _x1); };
+
+
+    private: inline Out ReadY(size_t i) const
+    {
+        Out y;
+
+        memcpy_P(&y, &_y[i], sizeof(Out));
+
+        return y;
+    };
+
+
+    private: Out Interpolate(In x, BoolType<true>, BoolType<Narrow>) const
+    {
+        float position = float(x - _x0) * _scale.f;
+        size_t i = size_t(position);
+
+        if (i > _size - 2) i = _size - 2;
+
+        Out y[2];
+
+        memcpy_P(y, &_y[i], sizeof(y));
+
+        return Out(lerp(float(y[0]), float(y[1]), position - float(i)));
+    };
+
+
+    private: Out Interpolate(In x, BoolType<false>, BoolType<false>) const
+    {
+        uint64_t position = uint64_t(int64_t(x) - int64_t(_x0)) * _scale.q32;
+
+        return Lerp(size_t(position >> 32), uint32_t(position >> 16) & 0xFFFF);
+    };
+
+
+    // (dx·scale) >> 16, computed in two parts that each fit 32 bits
+    private: Out Interpolate(In x, BoolType<false>, BoolType<true>) const
+    {
+        uint32_t dx = uint32_t(int32_t(x) - int32_t(_x0));
+        uint32_t position = dx * _scale.q16.whole + ((dx * _scale.q16.fraction) >> 16);
+
+        return Lerp(size_t(position >> 16), position & 0xFFFF);
+    };
+
+
+    private: Out Lerp(size_t i, uint32_t fraction) const
+    {
+        if (i > _size - 2) i = _size - 2;
+
+        Out y[2];
+
+        memcpy_P(y, &_y[i], sizeof(y));
+
+        return Out(lerp_q16(int32_t(y[0]), int32_t(y[1]), fraction));
+    };
+
+
+    private: In _x0;
+    private: In _x1;
+    private: const Out* _y;
+
+    // Table intervals per unit of input
+    private: union
+    {
+        float f;
+        uint64_t q32;
+        struct { uint32_t whole; uint16_t fraction; } q16;
+    } _scale;
+};
+
+#endif
@@ -107,6 +107,48 @@ float cosine(const int deg)
 }
 
 
+/*******************************************************************************
+SinCos reduces the angle to x = angle - k·π/2, with k the nearest integer to 
+angle/(π/2), so that |x| <= π/4. k·π/2 is subtracted in three parts, the first 
+two having only 17 significant bits each, so that their products with k are 
+exact and the reduction itself loses no precision for moderate angles. Over 
+±π/4 the Taylor series
+
+sin(x) = x - x³/3! + x⁵/5! - x⁷/7! + x⁹/9!
+cos(x) = 1 - x²/2! + x⁴/4! - x⁶/6! + x⁸/8!
+
+are accurate to better than 1e-7, and both share the single x² term. The 
+quadrant, k mod 4, then selects which of them is the sine and which the cosine, 
+and their signs:
+
+k mod 4:    0       1       2       3
+sin:        sin(x)  cos(x)  -sin(x) -cos(x)
+cos:        cos(x)  -sin(x) -cos(x) sin(x)
+*******************************************************************************/
+void SinCos(float angle, float& s, float& c)
+{
+    const float TWO_OVER_PI = 0.63661977f;
+    const float PIO2_1 = 1.5707855225e+00f;     // The first 17 bits of π/2
+    const float PIO2_2 = 1.0804273188e-05f;     // The next 17 bits
+    const float PIO2_3 = 6.0770999344e-11f;     // π/2 - PIO2_1 - PIO2_2
+
+    float kf = floor(angle * TWO_OVER_PI + 0.5f);
+    float x = ((angle - kf * PIO2_1) - kf * PIO2_2) - kf * PIO2_3;
+    float x2 = x * x;
+
+    float sx = x * (1 - x2 * (1.0f / 6) * (1 - x2 * (1.0f / 20) * (1 - x2 * (1.0f / 42) * (1 - x2 * (1.0f / 72)))));
+    float cx = 1 - x2 * 0.5f * (1 - x2 * (1.0f / 12) * (1 - x2 * (1.0f / 30) * (1 - x2 * (1.0f / 56))));
+
+    switch (long(kf) & 3)
+    {
+        case 0: s = sx;  c = cx;  break;
+        case 1: s = cx;  c = -sx; break;
+        case 2: s = -sx; c = -cx; break;
+        default: s = -cx; c = sx; break;
+    }
+}
+
+
 /*******************************************************************************
 A fast method for computing the arctangent of a value.
 *******************************************************************************/
@@ -133,10 +175,11 @@ float invsqrt(float x)
 
     float y = x;                                // The end result
     float x2 = x * 0.5F;                        // 1/2 of x - save for later use in Newton's method
-    long  i = *(long*)&y;                       // Evil floating point bit-level hacking
+    int32_t i;
 
+    memcpy(&i, &y, sizeof(i));                  // Evil floating point bit-level hacking (int32_t, since long is 64 bits on some hosts)
     i = 0x5f3759df - ( i >> 1 );                // Magic! Too complicated to explain here.
-    y = *(float*)&i;                            // Hack the hack above
+    memcpy(&y, &i, sizeof(y));                  // Hack the hack above
     y = y * ( threehalfs - ( x2 * y * y ) );    // 1st iteration of Newton's method to refine the result
 //  y = y * ( threehalfs - ( x2 * y * y ) );    // 2nd iteration of Newton's method, if necessary
 
@@ -1,10 +1,8 @@
 #ifndef _RTL_Math_h_
 #define _RTL_Math_h_
 
-#include "PolarVector2D.h"
-#include "StateVector2D.h"
-#include "Vector3.h"
-#include "Point2D.h"
+#include <stdlib.h>
+#include <inttypes.h>
 
 
 //******************************************************************************
@@ -51,6 +49,15 @@ float cosine(const float angle);
 //******************************************************************************
 float cosine(const int deg);
 
+//******************************************************************************
+/// Finds both the sine and the cosine of an angle specified in radians, from a
+/// single evaluation. The angle is reduced to within ±π/4 of a multiple of π/2
+/// and both are computed from short polynomials in the remainder, to within a
+/// few units in the last place of a float (much closer than sine()/cosine()).
+/// This is cheaper than calling sin() and cos() separately.
+//******************************************************************************
+void SinCos(float angle, float& s, float& c);
+
 //******************************************************************************
 /// Finds the arctanget of two values that comprise the legs of a right triangle,
 /// where 'a' is the numerator (the 'rise') and 'b' is the denominator (the 'run'). 
@@ -64,4 +71,26 @@ A fast method for computing a good approximation of 1/√x, the inverse square r
 *******************************************************************************/
 float invsqrt(float x);
 
+/*******************************************************************************
+ Linear interpolation
+*******************************************************************************/
+
+//******************************************************************************
+/// Interpolates linearly between a (at t = 0) and b (at t = 1).
+//******************************************************************************
+inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+//******************************************************************************
+/// Interpolates linearly between a and b, where t is a Q16 fixed-point fraction
+/// (0 to 65535 represents 0 to just under 1).
+//******************************************************************************
+inline int32_t lerp_q16(int32_t a, int32_t b, uint32_t t) { return a + int32_t((int64_t(b) - a) * int64_t(t) >> 16); }
+
+
+// The vector types use the functions above, so they are included after them
+#include "PolarVector2D.h"
+#include "StateVector2D.h"
+#include "Vector3.h"
+#include "Point2D.h"
+
 #endif
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ This module implements the Odometry (dead-reckoning) class.
+
+ For a step where the left and right wheels travel dL and dR, the robot moves
+ ds = (dL + dR)/2 along the path and turns dθ = (dR - dL)/trackWidth. With
+ constant wheel speeds over the step the path is a circular arc, and the net
+ displacement is the chord of that arc: length ds·sin(dθ/2)/(dθ/2), in the
+ direction of the heading at the middle of the step (θ + dθ/2). The midpoint
+ method uses the same direction but the full length ds.
+
+ Both methods need the sine and cosine of the half-step angle, which come from
+ one SinCos() evaluation (see RTL_Math.h). The heading sine/cosine are
+ then rotated by the half angle twice: once to get the midpoint direction and
+ once more to get the new heading.
+*******************************************************************************/
+
+#include <math.h>
+#include <Arduino.h>
+#include "RTL_Math.h"
+#include "RTL_Odometry.h"
+
+
+// Steps between re-synchronizing the incremental sine/cosine with the heading
+static const uint8_t RESYNC_INTERVAL = 64;
+
+// Wraps an angle in radians into -π to +π
+static inline float WrapAngle(float theta)
+{
+    if (theta > PI)
+        theta -= TWO_PI;
+    else if (theta < -PI)
+        theta += TWO_PI;
+
+    return theta;
+}
+
+
+Odometry::Odometry(float trackWidth, OdometryMethod method) : _invTrackWidth(1 / trackWidth), _method(method)
+{
+    Reset();
+}
+
+
+void Odometry::Reset(float x, float y, float heading)
+{
+    _x = x;
+    _y = y;
+    _theta = WrapAngle(fmod(radians(heading), TWO_PI));
+    _distance = 0;
+    Resync();
+}
+
+
+void Odometry::Update(float dLeft, float dRight)
+{
+    float ds = 0.5f * (dLeft + dRight);
+    float half = 0.5f * (dRight - dLeft) * _invTrackWidth;
+    float sh, ch;
+
+    SinCos(half, sh, ch);
+
+    // Heading at the middle of the step
+    float ms = _sin * ch + _cos * sh;
+    float mc = _cos * ch - _sin * sh;
+
+    float length = ds;
+
+    if (_method == OdometryMethod::ExactArc && half != 0) length *= sh / half;
+
+    _x -= ms * length;
+    _y += mc * length;
+    _distance += fabs(ds);
+
+    // Heading at the end of the step
+    _theta = WrapAngle(_theta + 2 * half);
+
+    if (++_steps >= RESYNC_INTERVAL)
+    {
+        Resync();
+    }
+    else
+    {
+        float s = ms * ch + mc * sh;
+        float c = mc * ch - ms * sh;
+
+        // One Newton step toward s² + c² = 1
+        float k = 1.5f - 0.5f * (s * s + c * c);
+
+        _sin = s * k;
+        _cos = c * k;
+    }
+}
+
+
+void Odometry::Replay(const EncoderDelta* deltas, size_t count)
+{
+    for (size_t i = 0; i < count; i++) Update(deltas[i].Left, deltas[i].Right);
+}
+
+
+StateVector2D Odometry::Pose() const
+{
+    return StateVector2D(_x, _y, Heading());
+}
+
+
+float Odometry::Heading() const
+{
+    return degrees(_theta);
+}
+
+
+void Odometry::Resync()
+{
+    SinCos(_theta, _sin, _cos);
+    _steps = 0;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef _RTL_Odometry_h_
+#define _RTL_Odometry_h_
+/*******************************************************************************
+ * Header file for the Odometry (dead-reckoning) class.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "StateVector2D.h"
+
+
+//******************************************************************************
+/// How each encoder step is integrated into the pose:
+///
+/// Midpoint - moves the full distance travelled along the heading at the middle
+///            of the step. Accurate to second order in the heading change.
+/// ExactArc - moves along the chord of the circular arc that the robot actually
+///            travels when the wheel speeds are constant over the step. Exact for
+///            constant-curvature steps, for the cost of one extra multiply and
+///            divide.
+//******************************************************************************
+enum class OdometryMethod : uint8_t
+{
+    Midpoint,
+    ExactArc
+};
+
+
+//******************************************************************************
+/// One step of wheel travel, in the same distance units as the track width.
+//******************************************************************************
+struct EncoderDelta
+{
+    float Left;
+    float Right;
+};
+
+
+//******************************************************************************
+/// Integrates differential-drive wheel encoder deltas into a StateVector2D pose.
+///
+/// The conventions are those of StateVector2D: heading is relative to the +y axis
+/// and positive angles are counter-clockwise, so the robot moves along
+/// (-sin(heading), cos(heading)).
+///
+/// Rather than calling sin() and cos() on the heading every step, the engine
+/// keeps the sine and cosine of the heading and rotates them by each step's
+/// (small) heading change, using a short polynomial for the sine and cosine of
+/// that change. They are re-normalized every step and re-synchronized with the
+/// exact heading periodically, so they do not drift.
+//******************************************************************************
+class Odometry
+{
+    public: Odometry(float trackWidth, OdometryMethod method=OdometryMethod::ExactArc);
+
+    //**************************************************************************
+    /// Sets the current pose. The heading is in degrees.
+    //**************************************************************************
+    public: void Reset(float x=0, float y=0, float heading=0);
+
+    public: inline void Reset(const StateVector2D& pose) { Reset(pose.X, pose.Y, pose.Heading); };
+
+    //**************************************************************************
+    /// Integrates one step of left and right wheel travel.
+    //**************************************************************************
+    public: void Update(float dLeft, float dRight);
+
+    //**************************************************************************
+    /// Integrates a block of steps, e.g. to replay a logged encoder stream.
+    //**************************************************************************
+    public: void Replay(const EncoderDelta* deltas, size_t count);
+
+    public: StateVector2D Pose() const;
+
+    public: inline float X() const { return _x; };
+
+    public: inline float Y() const { return _y; };
+
+    // The heading in degrees, in the range -180 to +180
+    public: float Heading() const;
+
+    // The total distance travelled (along the path) since the last Reset()
+    public: inline float Distance() const { return _distance; };
+
+    private: void Resync();
+
+    private: float _invTrackWidth;
+    private: OdometryMethod _method;
+    private: float _x;
+    private: float _y;
+    private: float _theta;              // Heading in radians, -π to +π
+    private: float _sin;                // sin(_theta), maintained incrementally
+    private: float _cos;                // cos(_theta), maintained incrementally
+    private: float _distance;
+    private: uint8_t _steps;            // Steps since the last re-synchronization
+};
+
+#endif
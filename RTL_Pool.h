@@ -0,0 +1,238 @@
+/*******************************************************************************
+Header file for Pool template class.
+*******************************************************************************/
+#ifndef _RTL_Pool_h_
+#define _RTL_Pool_h_
+
+#include <inttypes.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Lock.h"
+
+
+//******************************************************************************
+/// A fixed-size object pool (slab allocator). Storage for _pool_size objects of
+/// type T is allocated statically as part of the pool, so objects can be created
+/// and destroyed indefinitely without ever touching (or fragmenting) the heap.
+///
+/// Free slots are kept in a singly linked free-list that is threaded through the
+/// unused slots themselves, so allocation and release are both O(1) and the
+/// free-list costs no additional RAM. A bitmap of allocated slots (one bit per
+/// slot) lets Free() and Destroy() reject a slot that is already free, which
+/// would otherwise link it into the free-list twice.
+///
+/// Every slot also has a Handle (its slot index), which is the smallest unsigned
+/// type that can hold _pool_size (so 1 byte for pools of up to 255 objects).
+/// Handles are smaller than pointers, so they are a compact way to pass pooled
+/// objects through a Queue or List, e.g. Queue<Pool<Event, 16>::Handle, 16>.
+///
+/// With the default LockPolicy (InterruptLock, see RTL_Lock.h) allocation and
+/// release are interrupt-safe, so objects may be created in an ISR and destroyed
+/// in loop() (or vice versa). A pool only used from one context can use NoLock.
+//******************************************************************************
+template <typename T, size_t _pool_size=10, typename LockPolicy=DefaultLock> class Pool : private LockPolicy
+{
+    public: typedef typename IndexType<_pool_size>::Type Handle;
+
+    // Valid handles are 0 to _pool_size - 1, so the largest Handle value is never one of them
+    public: static const Handle NullHandle = Handle(~Handle(0));
+
+    static_assert(_pool_size > 0, "Pool size must be at least 1");
+
+
+    public: Pool() : _freeHead(0), _used(0), _peak(0), _failures(0)
+    {
+        for (Handle i = 0; i < _pool_size - 1; i++) _slots[i].Next = i + 1;
+
+        _slots[_pool_size - 1].Next = NullHandle;
+
+        for (size_t i = 0; i < sizeof(_allocated); i++) _allocated[i] = 0;
+    };
+
+
+    //**************************************************************************
+    /// Allocates an uninitialized slot large enough to hold a T. Returns NULL if
+    /// the pool is exhausted. The caller is responsible for constructing the
+    /// object (prefer Create(), which does that).
+    //**************************************************************************
+    public: void* Allocate()
+    {
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
+
+        if (_freeHead == NullHandle)
+        {
+            if (_failures < 0xFFFF) _failures++;
+
+            return NULL;
+        }
+
+        Slot* slot = &_slots[_freeHead];
+
+        SetAllocated(_freeHead, true);
+        _freeHead = slot->Next;
+
+        if (++_used > _peak) _peak = _used;
+
+        return slot->Storage;           // ATOMIC BLOCK END
+    }
+
+
+    //**************************************************************************
+    /// Returns a slot obtained from Allocate() to the pool without running any
+    /// destructor. Returns false if the pointer does not belong to this pool or
+    /// its slot is not allocated (e.g. it has already been freed).
+    //**************************************************************************
+    public: bool Free(void* p)
+    {
+        Handle handle = HandleOf(static_cast<T*>(p));
+
+        if (handle == NullHandle) return false;
+
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
+
+        if (!IsAllocated(handle)) return false;
+
+        SetAllocated(handle, false);
+        Release(handle);
+
+        return true;                    // ATOMIC BLOCK END
+    }
+
+
+    //**************************************************************************
+    /// Allocates a slot and constructs a T in it, forwarding the arguments to
+    /// T's constructor. Returns NULL if the pool is exhausted.
+    //**************************************************************************
+    public: template <typename... Args> T* Create(Args&&... args)
+    {
+        void* p = Allocate();
+
+        return (p != NULL) ? new (p) T(Forward<Args>(args)...) : NULL;
+    }
+
+
+    //**************************************************************************
+    /// Destroys an object obtained from Create() and returns its slot to the pool.
+    /// Returns false (and destroys nothing) if the object is not allocated from
+    /// this pool.
+    //**************************************************************************
+    public: bool Destroy(T* obj)
+    {
+        Handle handle = HandleOf(obj);
+
+        if (handle == NullHandle) return false;
+
+        // Claim the object by clearing its allocated bit, so that a concurrent
+        // Destroy() or Free() of the same object fails instead of repeating this
+        {
+            Guard guard(*this);         // ATOMIC BLOCK BEGIN
+
+            if (!IsAllocated(handle)) return false;
+
+            SetAllocated(handle, false);
+        }                               // ATOMIC BLOCK END
+
+        obj->~T();
+
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
+
+        Release(handle);
+
+        return true;                    // ATOMIC BLOCK END
+    }
+
+
+    public: inline bool Destroy(Handle handle) { return Destroy(Get(handle)); };
+
+
+    //**************************************************************************
+    /// Converts between object pointers and handles. HandleOf() returns NullHandle
+    /// and Get() returns NULL for values that do not belong to this pool.
+    //**************************************************************************
+    public: Handle HandleOf(const T* obj) const
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(obj);
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(_slots);
+
+        if (p < base || p >= base + sizeof(_slots)) return NullHandle;
+        if ((p - base) % sizeof(Slot) != 0) return NullHandle;
+
+        return Handle((p - base) / sizeof(Slot));
+    }
+
+
+    public: inline T* Get(Handle handle)
+    {
+        return (handle < _pool_size) ? reinterpret_cast<T*>(_slots[handle].Storage) : NULL;
+    };
+
+
+    public: inline T* operator[](Handle handle) { return Get(handle); };
+
+
+    /***************************************************************************
+    Usage statistics
+    ***************************************************************************/
+    public: static constexpr size_t Capacity() { return _pool_size; };
+
+    public: inline Handle Used() const { return _used; };
+
+    public: inline Handle Available() const { return _pool_size - _used; };
+
+    public: inline bool IsEmpty() const { return (_used == 0); };
+
+    public: inline bool IsFull() const { return (_used == _pool_size); };
+
+    // The largest number of objects that have been allocated at the same time
+    public: inline Handle Peak() const { return _peak; };
+
+    // The number of allocations that failed because the pool was exhausted
+    public: inline uint16_t Failures() const { return _failures; };
+
+    public: void ResetStatistics()
+    {
+        Guard guard(*this);
+
+        _peak = _used;
+        _failures = 0;
+    }
+
+
+    private: typedef typename LockPolicy::Guard Guard;
+
+
+    private: union Slot
+    {
+        Handle Next;
+        alignas(T) uint8_t Storage[sizeof(T)];
+    };
+
+    // Pushes a slot that is no longer allocated onto the free-list (lock held)
+    private: inline void Release(Handle i)
+    {
+        _slots[i].Next = _freeHead;
+        _freeHead = i;
+        _used--;
+    };
+
+
+    private: inline bool IsAllocated(Handle i) const { return (_allocated[i >> 3] & (1 << (i & 7))) != 0; };
+
+
+    private: inline void SetAllocated(Handle i, bool allocated)
+    {
+        if (allocated)
+            _allocated[i >> 3] |= uint8_t(1 << (i & 7));
+        else
+            _allocated[i >> 3] &= uint8_t(~(1 << (i & 7)));
+    };
+
+
+    private: Slot _slots[_pool_size];
+    private: uint8_t _allocated[(_pool_size + 7) / 8];
+    private: Handle _freeHead;
+    private: Handle _used;
+    private: Handle _peak;
+    private: uint16_t _failures;
+};
+
+#endif
@@ -0,0 +1,209 @@
+/*******************************************************************************
+Header file for PriorityQueue template class.
+*******************************************************************************/
+#ifndef _RTL_PriorityQueue_h_
+#define _RTL_PriorityQueue_h_
+
+#include <inttypes.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Lock.h"
+
+
+//******************************************************************************
+/// A bounded, interrupt-safe priority queue for deadline-driven dispatch.
+///
+/// Items are kept in a small, fixed number of FIFO rings, one per priority level.
+/// Priority 0 is the most urgent; higher numbers are less urgent. Remove() always
+/// returns the oldest item of the most urgent non-empty level, so items with the
+/// same priority are dispatched in the order they were added, and an urgent item
+/// never waits behind less urgent ones queued before it.
+///
+/// Each priority level holds up to _queue_size items. A bitmask of non-empty
+/// levels is maintained so that both Add() and Remove() are O(1); the work done
+/// with interrupts disabled is a few loads and stores, regardless of how many
+/// items are queued.
+///
+/// Items are kept in uninitialized storage and constructed only when added, so
+/// T need not be default-constructible.
+///
+/// LockPolicy (see RTL_Lock.h) determines how the queue is protected against
+/// concurrent access; the default, InterruptLock, makes it interrupt-safe.
+//******************************************************************************
+template <typename T, uint8_t _queue_size=10, uint8_t _priorities=4, typename LockPolicy=DefaultLock> class PriorityQueue : private LockPolicy
+{
+    static_assert(_priorities > 0 && _priorities <= 8, "PriorityQueue supports 1 to 8 priority levels");
+
+    public: static const uint8_t LowestPriority = _priorities - 1;
+
+    public: PriorityQueue() : _ready(0)
+    {
+        for (uint8_t i = 0; i < _priorities; i++) _head[i] = _count[i] = 0;
+    };
+
+
+    public: ~PriorityQueue()
+    {
+        for (uint8_t level = 0; level < _priorities; level++)
+        {
+            for (; _count[level] > 0; _count[level]--)
+            {
+                Slot(level, _head[level])->~T();
+                _head[level] = (_head[level] + 1 < _queue_size) ? _head[level] + 1 : 0;
+            }
+        }
+    }
+
+
+    // Queues are shared with ISRs through a fixed address, so they are not copied
+    private: PriorityQueue(const PriorityQueue&) = delete;
+    private: PriorityQueue& operator=(const PriorityQueue&) = delete;
+
+
+    //**************************************************************************
+    /// Adds an item at the specified priority (0 is the most urgent). Priorities
+    /// beyond the lowest level are treated as the lowest level. Returns false if
+    /// that level is full.
+    //**************************************************************************
+    public: bool Add(T item, uint8_t priority=LowestPriority)
+    {
+        /*
+        As with Queue::Add(), the full check and the insert must be one atomic
+        operation since items may be added from both interrupt and normal code.
+        */
+
+        priority = Clamp(priority);
+
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
+
+        uint8_t count = _count[priority];
+
+        if (count == _queue_size) return false;
+
+        // Computed in 16 bits, since head + count can exceed 255 for sizes over 128
+        uint16_t tail = uint16_t(_head[priority]) + count;
+
+        if (tail >= _queue_size) tail -= _queue_size;
+
+        new (Slot(priority, uint8_t(tail))) T(Move(item));
+        _count[priority] = count + 1;
+        _ready |= uint8_t(1 << priority);
+
+        return true;                    // ATOMIC BLOCK END
+    }
+
+
+    //**************************************************************************
+    /// Removes the oldest item of the most urgent non-empty priority level. The
+    /// item's priority is optionally returned. Returns false if the queue is empty.
+    //**************************************************************************
+    public: bool Remove(T& item, uint8_t* priority=NULL)
+    {
+        /*
+        As with Queue::Remove(), the empty check is done before disabling interrupts
+        so that polling an empty queue in loop() does not keep interrupts disabled
+        (where the lock policy allows an unlocked read, see RTL_Lock.h).
+        */
+
+        if (LockPolicy::UnlockedPeek && _ready == 0) return false;
+
+        uint8_t level;
+
+        {
+            Guard guard(*this);         // ATOMIC BLOCK BEGIN
+
+            if (_ready == 0) return false;
+
+            level = Highest(_ready);
+
+            uint8_t head = _head[level];
+            T* slot = Slot(level, head);
+
+            item = Move(*slot);
+            slot->~T();
+            _head[level] = (head + 1 < _queue_size) ? head + 1 : 0;
+
+            if (--_count[level] == 0) _ready &= uint8_t(~(1 << level));
+        }                               // ATOMIC BLOCK END
+
+        if (priority != NULL) *priority = level;
+
+        return true;
+    }
+
+
+    public: bool Peek(T& item, uint8_t* priority=NULL)
+    {
+        if (LockPolicy::UnlockedPeek && _ready == 0) return false;
+
+        uint8_t level;
+
+        {
+            Guard guard(*this);         // ATOMIC BLOCK BEGIN
+
+            if (_ready == 0) return false;
+
+            level = Highest(_ready);
+            item = *Slot(level, _head[level]);
+        }                               // ATOMIC BLOCK END
+
+        if (priority != NULL) *priority = level;
+
+        return true;
+    }
+
+
+    public: inline bool IsEmpty() { return (Read(_ready) == 0); };
+
+
+    //**************************************************************************
+    /// The state of one priority level. As in Add(), priorities beyond the
+    /// lowest level refer to the lowest level.
+    //**************************************************************************
+    public: inline bool IsEmpty(uint8_t priority) { return (Count(priority) == 0); };
+
+
+    public: inline bool IsFull(uint8_t priority) { return (Count(priority) == _queue_size); };
+
+
+    public: inline uint8_t Count(uint8_t priority) { return Read(_count[Clamp(priority)]); };
+
+
+    private: static inline uint8_t Clamp(uint8_t priority) { return (priority > LowestPriority) ? LowestPriority : priority; };
+
+
+    // Index of the lowest set bit, i.e. the most urgent non-empty level
+    private: static inline uint8_t Highest(uint8_t mask)
+    {
+        uint8_t level = 0;
+
+        while ((mask & 1) == 0) { mask >>= 1; level++; }
+
+        return level;
+    }
+
+
+    private: typedef typename LockPolicy::Guard Guard;
+
+
+    // Reads a byte of state, under the lock unless the policy allows unlocked reads
+    private: inline uint8_t Read(const volatile uint8_t& value)
+    {
+        if (LockPolicy::UnlockedPeek) return value;
+
+        Guard guard(*this);
+
+        return value;
+    }
+
+
+    private: inline T* Slot(uint8_t level, uint8_t index) { return reinterpret_cast<T*>(_storage) + level * _queue_size + index; };
+
+
+    // Raw storage: only the _count[level] slots from _head[level] hold constructed items
+    private: alignas(T) uint8_t _storage[sizeof(T) * _priorities * _queue_size];
+    private: uint8_t _head[_priorities];
+    private: uint8_t _count[_priorities];
+    private: volatile uint8_t _ready;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*******************************************************************************
+ This module implements the QueueStats class, which collects the optional
+ Queue instrumentation enabled by defining RTL_QUEUE_STATS. When it is not
+ defined this module is empty.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Queue.h"
+
+
+#if defined(RTL_QUEUE_STATS)
+
+// The list of every queue's statistics is shared by all of the queues, which
+// may be created by different threads on the host, so it has its own lock.
+#if defined(ARDUINO)
+typedef InterruptLock RegistryLock;
+#else
+typedef MutexLock RegistryLock;
+#endif
+
+static RegistryLock registryLock;
+
+
+QueueStats* QueueStats::_first = NULL;
+QueueStats* QueueStats::_cursor = NULL;
+
+
+QueueStats::QueueStats(size_t capacity) : _next(NULL), _name(NULL), _capacity(capacity)
+{
+    ResetUnlocked();
+}
+
+
+void QueueStats::Register()
+{
+    RegistryLock::Guard guard(registryLock);
+
+    // Append, so that DumpQueueStats() lists queues in construction order
+    QueueStats** link = &_first;
+
+    while (*link != NULL) link = &(*link)->_next;
+
+    *link = this;
+}
+
+
+void QueueStats::Unregister()
+{
+    RegistryLock::Guard guard(registryLock);
+
+    // Keep a dump in progress from stepping onto this queue once it is gone
+    if (_cursor == this) _cursor = _next;
+
+    for (QueueStats** link = &_first; *link != NULL; link = &(*link)->_next)
+    {
+        if (*link == this)
+        {
+            *link = _next;
+            break;
+        }
+    }
+}
+
+
+void QueueStats::ResetUnlocked()
+{
+    _counters.Peak = 0;
+    _counters.Rejects = 0;
+
+    for (uint8_t i = 0; i < LatencyBuckets; i++) _counters.Latency[i] = 0;
+}
+
+
+void QueueStats::Removed(uint32_t latency)
+{
+    uint8_t bucket = 0;
+
+    while (latency != 0 && bucket < LatencyBuckets - 1)
+    {
+        latency >>= 1;
+        bucket++;
+    }
+
+    if (_counters.Latency[bucket] != 0xFFFF) _counters.Latency[bucket]++;
+}
+
+
+void QueueStats::Dump(Print& stream)
+{
+    Counters counters;
+
+    Read(counters);
+    PrintCounters(stream, _name, _capacity, counters);
+}
+
+
+void QueueStats::PrintCounters(Print& stream, const __FlashStringHelper* name, size_t capacity, const Counters& counters)
+{
+    if (name != NULL) stream << name; else stream << F("Queue");
+
+    stream << F(": capacity=") << capacity << F(" peak=") << counters.Peak << F(" rejects=") << counters.Rejects;
+    stream << F(" latency(us):");
+
+    for (uint8_t i = 0; i < LatencyBuckets; i++)
+    {
+        if (counters.Latency[i] == 0) continue;
+
+        if (i < LatencyBuckets - 1)
+            stream << F(" <") << (uint32_t(1) << i) << '=' << counters.Latency[i];
+        else
+            stream << F(" >=") << (uint32_t(1) << (i - 1)) << '=' << counters.Latency[i];
+    }
+
+    stream << F("\r\n");
+}
+
+
+void DumpQueueStats(Print& stream)
+{
+    {
+        RegistryLock::Guard guard(registryLock);
+
+        QueueStats::_cursor = QueueStats::_first;
+    }
+
+    for (uint16_t number = 0; ; number++)
+    {
+        const __FlashStringHelper* name;
+        size_t capacity;
+        QueueStats::Counters counters;
+
+        // Copy the statistics of the queue at the cursor and step past it with
+        // the list locked (so it cannot be destroyed meanwhile), but print them
+        // without the lock. A queue destroyed meanwhile moves the cursor on.
+        {
+            RegistryLock::Guard guard(registryLock);
+
+            QueueStats* stats = QueueStats::_cursor;
+
+            if (stats == NULL) break;
+
+            QueueStats::_cursor = stats->_next;
+
+            name = stats->_name;
+            capacity = stats->_capacity;
+            stats->Read(counters);
+        }
+
+        stream << '[' << number << F("] ");
+        QueueStats::PrintCounters(stream, name, capacity, counters);
+    }
+}
+
+#endif
@@ -5,14 +5,229 @@ Header file for Queue template class.
 #define _Queue_h_
 
 #include <inttypes.h>
+#include "RTL_Stdlib.h"
+#include "RTL_Lock.h"
+
+
+#if defined(RTL_QUEUE_STATS)
+
+//******************************************************************************
+/// Occupancy and latency statistics for a Queue, for checking that queue sizes
+/// are right. Statistics are only collected when RTL_QUEUE_STATS is defined for
+/// the whole build (e.g. with -DRTL_QUEUE_STATS); otherwise neither this class
+/// nor any of the bookkeeping in Queue is compiled, and queues are unchanged.
+///
+/// Every queue's statistics register themselves in a list when the queue is
+/// constructed, so DumpQueueStats() can print them all at once. The list is
+/// protected by its own lock (an InterruptLock on Arduino, a MutexLock on the
+/// host). DumpQueueStats() walks it once with a cursor that a queue being
+/// destroyed moves past itself, so queues may be created and destroyed during
+/// a dump: a destroyed queue is simply not printed, and no other is skipped.
+///
+/// The time each item spends in the queue (from Add() to Remove()) is measured
+/// with micros() and counted in a histogram with power-of-two buckets: bucket 0
+/// counts 0 µs, bucket b counts 2^(b-1) to 2^b - 1 µs, and the last bucket
+/// counts everything longer.
+///
+/// The counters are updated by the queue with its lock held. Reset(), Read()
+/// and Dump() take the same lock (through LockedQueueStats, below), so they
+/// see a consistent snapshot whatever the queue's LockPolicy.
+//******************************************************************************
+class QueueStats
+{
+    public: static const uint8_t LatencyBuckets = 16;
+
+    public: struct Counters
+    {
+        size_t Peak;                        // Most items in the queue at once
+        uint32_t Rejects;                   // Items rejected because the queue was full
+        uint16_t Latency[LatencyBuckets];   // Latency histogram
+    };
+
+    public: QueueStats(size_t capacity);
+
+    public: virtual ~QueueStats() { };
+
+    // Sets the name printed by Dump()
+    public: inline void SetName(const __FlashStringHelper* name) { _name = name; };
+
+    public: inline size_t Capacity() const { return _capacity; };
+
+    // Copies the counters, with the queue's lock held
+    public: virtual void Read(Counters& counters) = 0;
+
+    // Clears the counters, with the queue's lock held
+    public: virtual void Reset() = 0;
+
+    public: void Dump(Print& stream);
+
+    // Called by Queue with its lock held
+    public: inline void Added(size_t count) { if (count > _counters.Peak) _counters.Peak = count; };
+
+    public: inline void Rejected() { if (_counters.Rejects != 0xFFFFFFFF) _counters.Rejects++; };
+
+    public: void Removed(uint32_t latency);
+
+    protected: void ResetUnlocked();
+
+    // Adds these statistics to the list, or removes them. The derived class
+    // calls these once it is fully constructed and before it is torn down, so
+    // DumpQueueStats() never sees it part-built (and calls a pure Read()).
+    protected: void Register();
+
+    protected: void Unregister();
+
+    protected: inline void ReadUnlocked(Counters& counters) const { counters = _counters; };
+
+    private: QueueStats(const QueueStats&) = delete;
+    private: QueueStats& operator=(const QueueStats&) = delete;
+
+    private: static void PrintCounters(Print& stream, const __FlashStringHelper* name, size_t capacity, const Counters& counters);
 
+    private: friend void DumpQueueStats(Print& stream);
 
-template <typename T, uint8_t _queue_size=10> class Queue
+    private: static QueueStats* _first;
+    private: static QueueStats* _cursor;        // Next to print in DumpQueueStats()
+    private: QueueStats* _next;
+    private: const __FlashStringHelper* _name;
+    private: size_t _capacity;
+    private: Counters _counters;
+};
+
+
+//******************************************************************************
+/// The QueueStats of a queue with a given LockPolicy, which it takes to read
+/// or reset the counters.
+//******************************************************************************
+template <typename LockPolicy> class LockedQueueStats : public QueueStats
 {
-    public: Queue() : _queueHead(0), _queueTail(0), _queueCount(0) { };
+    public: LockedQueueStats(size_t capacity, LockPolicy& lock) : QueueStats(capacity), _lock(lock)
+    {
+        {
+            typename LockPolicy::Guard guard(_lock);
 
+            ResetUnlocked();
+        }
+
+        Register();
+    };
 
-    public: bool Add(T item)
+    public: virtual ~LockedQueueStats() { Unregister(); };
+
+    public: virtual void Read(Counters& counters)
+    {
+        typename LockPolicy::Guard guard(_lock);
+
+        ReadUnlocked(counters);
+    };
+
+    public: virtual void Reset()
+    {
+        typename LockPolicy::Guard guard(_lock);
+
+        ResetUnlocked();
+    };
+
+    private: LockPolicy& _lock;
+};
+
+
+//******************************************************************************
+/// Prints the statistics of every queue. Only one dump may run at a time.
+//******************************************************************************
+void DumpQueueStats(Print& stream);
+
+#endif
+
+
+//******************************************************************************
+/// What Queue::Add() does when the queue is full.
+//******************************************************************************
+enum class QueueMode : uint8_t
+{
+    Reject,         // The new item is rejected (Add() returns false)
+    Overwrite,      // The oldest item is discarded to make room for the new one
+};
+
+
+// The overrun counter is only present in Overwrite mode
+template <QueueMode _mode> struct QueueOverruns { };
+
+template <> struct QueueOverruns<QueueMode::Overwrite>
+{
+    QueueOverruns() : _overruns(0) { };
+
+    uint32_t _overruns;
+};
+
+
+//******************************************************************************
+/// A fixed-size, interrupt-safe FIFO queue.
+///
+/// The head, tail and count use the smallest unsigned type that can hold
+/// _queue_size (see IndexType), so queues of up to 255 items keep single-byte
+/// bookkeeping, while larger queues (e.g. host log-replay buffers) are possible.
+/// Power-of-two sizes wrap the indexes with a mask instead of a compare.
+///
+/// LockPolicy (see RTL_Lock.h) determines how the queue is protected against
+/// concurrent access. The default, InterruptLock, makes it safe to use between
+/// ISRs and loop(); a queue only used from one context can use NoLock.
+///
+/// In QueueMode::Overwrite the queue is a ring buffer that always keeps the
+/// newest _queue_size items: Add() never fails, and each item it discards is
+/// counted by Overruns(). See also RingBuffer below.
+//******************************************************************************
+template <typename T, size_t _queue_size=10, typename LockPolicy=DefaultLock, QueueMode _mode=QueueMode::Reject>
+class Queue : private LockPolicy, private QueueOverruns<_mode>
+{
+    static_assert(_queue_size > 0, "Queue size must be at least 1");
+
+    public: typedef typename IndexType<_queue_size>::Type Index;
+
+
+#if defined(RTL_QUEUE_STATS)
+    public: Queue() : _queueHead(0), _queueTail(0), _queueCount(0), _queueNotEmpty(0), _stats(_queue_size, *this) { };
+#else
+    public: Queue() : _queueHead(0), _queueTail(0), _queueCount(0), _queueNotEmpty(0) { };
+#endif
+
+
+    public: ~Queue()
+    {
+        for (; _queueCount > 0; _queueCount--)
+        {
+            Slot(_queueHead)->~T();
+            _queueHead = Next(_queueHead);
+        }
+    }
+
+
+    // Queues are shared with ISRs through a fixed address, so they are not copied
+    private: Queue(const Queue&) = delete;
+    private: Queue& operator=(const Queue&) = delete;
+
+
+    //**************************************************************************
+    /// Adds a copy of an item to the tail of the queue. Returns false if the
+    /// queue is full (which never happens in Overwrite mode).
+    //**************************************************************************
+    public: inline bool Add(const T& item) { return Emplace(item); };
+
+
+    //**************************************************************************
+    /// Moves an item into the tail of the queue, so payloads that are expensive
+    /// to copy (or cannot be copied at all) are transferred without a copy.
+    //**************************************************************************
+    public: inline bool Add(T&& item) { return Emplace(Move(item)); };
+
+
+    //**************************************************************************
+    /// Constructs an item directly in the tail slot of the queue, forwarding the
+    /// arguments to T's constructor. If the queue is full, returns false (and
+    /// constructs nothing), or in Overwrite mode discards the oldest item first.
+    /// The constructor runs while the lock is held, so it should be short.
+    //**************************************************************************
+    public: template <typename... Args> bool Emplace(Args&&... args)
     {
         /*
         Interrupts MUST be disabled while an item is being queued to ensure stability
@@ -37,26 +252,35 @@ template <typename T, uint8_t _queue_size=10> class Queue
         Contrast this with the logic in the Remove() method.
         */
 
-        bool isQueued = false;
-        int  i = _queueTail;
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
 
-        noInterrupts();                 // ATOMIC BLOCK BEGIN
-
-        if (_queueCount <= EVENT_QUEUE_SIZE)
+        if (_queueCount == _queue_size && !DropOldest(BoolType<_mode == QueueMode::Overwrite>()))
         {
-            _queue[_queueTail] = item;
-            _queueTail = (_queueTail + 1) % EVENT_QUEUE_SIZE;
-            _queueCount++;
-
-            isQueued = true;
+#if defined(RTL_QUEUE_STATS)
+            _stats.Rejected();
+#endif
+            return false;
         }
 
-        interrupts();                   // ATOMIC BLOCK END
+        new (Slot(_queueTail)) T(Forward<Args>(args)...);
+
+#if defined(RTL_QUEUE_STATS)
+        _stamps[_queueTail] = micros();
+        _stats.Added(_queueCount + 1);
+#endif
+
+        _queueTail = Next(_queueTail);
+        _queueCount++;
+        _queueNotEmpty = 1;
 
-        return isQueued;
+        return true;                    // ATOMIC BLOCK END
     }
 
 
+    //**************************************************************************
+    /// Removes the item at the head of the queue, moving it into item. Returns
+    /// false if the queue is empty.
+    //**************************************************************************
     public: bool Remove(T& item)
     {
         /*
@@ -76,48 +300,205 @@ template <typename T, uint8_t _queue_size=10> class Queue
         want interrupts turned off when we actually have an item to de-queue.
 
         Contrast this with the logic in the Queue() method.
+
+        The early check reads the count without taking the lock, so it is only made
+        where that is safe (see IsEmptyUnlocked()), and it is repeated once the lock
+        is held.
         */
 
-        if (_queueHead == _queueTail) return false;
+        if (IsEmptyUnlocked()) return false;
 
-        noInterrupts();                 // ATOMIC BLOCK BEGIN
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
 
-        item = _queue[_queueHead];
-        _queueHead = (_queueHead + 1) % EVENT_QUEUE_SIZE;
-        _queueCount--;
+        if (_queueCount == 0) return false;
 
-        interrupts();                   // ATOMIC BLOCK END
+        T* slot = Slot(_queueHead);
 
-        return true;
+        item = Move(*slot);
+        slot->~T();
+
+#if defined(RTL_QUEUE_STATS)
+        _stats.Removed(micros() - _stamps[_queueHead]);
+#endif
+
+        _queueHead = Next(_queueHead);
+        _queueCount--;
+        _queueNotEmpty = (_queueCount != 0);
+
+        return true;                    // ATOMIC BLOCK END
     }
 
 
-    public: inline bool Peek(T& item)
+    //**************************************************************************
+    /// Removes up to count items from the head of the queue, moving them into
+    /// the items array, oldest first. Returns the number of items removed. The
+    /// lock is taken once for the whole batch rather than once per item.
+    //**************************************************************************
+    public: Index Remove(T* items, Index count)
     {
-        if (!IsEmpty())
+        if (IsEmptyUnlocked()) return 0;
+
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
+
+        if (count > _queueCount) count = _queueCount;
+
+        for (Index i = 0; i < count; i++)
         {
-            noInterrupts();             // ATOMIC BLOCK BEGIN
-            item = _queue[_queueHead];
-            interrupts();               // ATOMIC BLOCK END
-            return true;
+            T* slot = Slot(_queueHead);
+
+            items[i] = Move(*slot);
+            slot->~T();
+
+#if defined(RTL_QUEUE_STATS)
+            _stats.Removed(micros() - _stamps[_queueHead]);
+#endif
+
+            _queueHead = Next(_queueHead);
         }
 
-        return false;
+        _queueCount -= count;
+        _queueNotEmpty = (_queueCount != 0);
+
+        return count;                   // ATOMIC BLOCK END
+    }
+
+
+    public: inline bool Peek(T& item)
+    {
+        if (IsEmptyUnlocked()) return false;
+
+        Guard guard(*this);             // ATOMIC BLOCK BEGIN
+
+        if (_queueCount == 0) return false;
+
+        item = *Slot(_queueHead);
+
+        return true;                    // ATOMIC BLOCK END
     };
 
 
-    public: inline bool IsFull() { return (_queueCount == _queue_size); };
+    public: inline bool IsFull() { return (Count() == _queue_size); };
+
+
+    public: inline bool IsEmpty() { return LockPolicy::UnlockedPeek ? !_queueNotEmpty : (Count() == 0); };
 
 
-    public: inline bool IsEmpty() { return (_queueCount == 0); };
+    public: static constexpr size_t Capacity() { return _queue_size; };
+
+
+#if defined(RTL_QUEUE_STATS)
+    public: inline QueueStats& Stats() { return _stats; };
+#endif
+
+
+    //**************************************************************************
+    /// Returns the number of items discarded to make room for new ones (only
+    /// available in Overwrite mode).
+    //**************************************************************************
+    public: inline uint32_t Overruns()
+    {
+        static_assert(_mode == QueueMode::Overwrite, "Overruns() is only available in QueueMode::Overwrite");
+
+        Guard guard(*this);
+
+        return this->_overruns;
+    };
 
 
-    private: const uint8_t EVENT_QUEUE_SIZE = _queue_size;
-    private: T _queue[_queue_size];
-    private: uint8_t _queueHead;
-    private: uint8_t _queueTail;
-    private: uint8_t _queueCount;
+    //**************************************************************************
+    /// Copies the items in the queue, oldest first, to out (which must have room
+    /// for Capacity() items) without removing them, and returns the number of
+    /// items copied. The items are copied in at most two blocks (a memcpy each
+    /// for trivially copyable types), so a snapshot of the last N samples of an
+    /// Overwrite mode queue costs the same however often it has wrapped.
+    //**************************************************************************
+    public: Index Snapshot(T* out)
+    {
+        Guard guard(*this);
+
+        Index count = _queueCount;
+        Index first = (_queueHead + count <= _queue_size) ? count : Index(_queue_size - _queueHead);
+
+        CopyN(out, Slot(_queueHead), first);
+        CopyN(out + first, Slot(0), count - first);
+
+        return count;
+    };
+
+
+    //**************************************************************************
+    /// Returns the number of items in the queue. The count is read under the
+    /// lock unless it is a single byte and the lock policy allows unlocked reads
+    /// (see RTL_Lock.h); a wider count could otherwise be read half-updated.
+    //**************************************************************************
+    public: inline Index Count()
+    {
+        if (sizeof(Index) == 1 && LockPolicy::UnlockedPeek) return _queueCount;
+
+        Guard guard(*this);
+
+        return _queueCount;
+    };
+
+
+    private: typedef typename LockPolicy::Guard Guard;
+
+
+    // True if the queue is empty, read without the lock. This is only done
+    // under a policy that allows it (see RTL_Lock.h), and otherwise returns
+    // false, leaving the caller to check under the lock. It reads the one-byte
+    // _queueNotEmpty rather than the count, so queues of more than 255 items
+    // can be polled without the lock too.
+    private: inline bool IsEmptyUnlocked() const
+    {
+        return LockPolicy::UnlockedPeek && !_queueNotEmpty;
+    };
+
+
+    // Makes room for a new item in a full queue
+    private: inline bool DropOldest(BoolType<false>) { return false; };
+
+    private: inline bool DropOldest(BoolType<true>)
+    {
+        Slot(_queueHead)->~T();
+        _queueHead = Next(_queueHead);
+        _queueCount--;
+
+        if (this->_overruns != 0xFFFFFFFF) this->_overruns++;
+
+        return true;
+    };
+
+
+    private: static inline Index Next(Index index)
+    {
+        return IsPowerOfTwo<_queue_size>::value ? Index((index + 1) & (_queue_size - 1)) : (index + 1 == _queue_size) ? Index(0) : Index(index + 1);
+    };
+
+
+    private: inline T* Slot(Index index) { return reinterpret_cast<T*>(_storage) + index; };
+
+
+    // Raw storage: a slot only holds a constructed T while it is in the queue
+    private: alignas(T) uint8_t _storage[sizeof(T) * _queue_size];
+    private: Index _queueHead;
+    private: Index _queueTail;
+    private: volatile Index _queueCount;
+    private: volatile uint8_t _queueNotEmpty;  // _queueCount != 0, as a single byte
+
+#if defined(RTL_QUEUE_STATS)
+    private: uint32_t _stamps[_queue_size];
+    private: LockedQueueStats<LockPolicy> _stats;
+#endif
 };
 
+
+//******************************************************************************
+/// A Queue in Overwrite mode: a fixed-size ring buffer of the newest items, for
+/// telemetry and "last N samples" diagnostic buffers.
+//******************************************************************************
+template <typename T, size_t _size=10, typename LockPolicy=DefaultLock>
+using RingBuffer = Queue<T, _size, LockPolicy, QueueMode::Overwrite>;
+
 #endif
 
@@ -0,0 +1,245 @@
+#pragma once
+#ifndef _RTL_SortedList_h_
+#define _RTL_SortedList_h_
+/*******************************************************************************
+ * Header file for the SortedList template class.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_Stdlib.h"
+#include "RTL_List.h"
+
+
+//******************************************************************************
+/// A List whose items are always kept in ascending order (as given by Compare,
+/// which defaults to operator<), for tables such as calibration points, sorted
+/// IDs or deadlines.
+///
+/// Searches are binary searches, so Find(), LowerBound() and UpperBound() are
+/// O(log n). Adding an item finds its position the same way and then opens a
+/// gap for it by moving the following items up (a single memmove for trivially
+/// copyable types). Items that compare equal are kept in the order they were
+/// added. InsertRange() adds a whole batch of items with a single merge pass.
+///
+/// The items are stored in the same way as a List and are protected by the
+/// same LockPolicy (see RTL_Lock.h). Items cannot be modified through the list,
+/// since that could break the ordering; remove and re-add them instead. Items
+/// are removed by value with Remove(), or by position with RemoveAt().
+//******************************************************************************
+template <typename T, size_t _list_size=10, typename Compare=Less<T>, typename LockPolicy=DefaultLock>
+class SortedList : private List<T, _list_size, LockPolicy>
+{
+    private: typedef List<T, _list_size, LockPolicy> Base;
+
+    public: typedef typename Base::Index Index;
+
+    public: using Base::Count;
+    public: using Base::IsEmpty;
+    public: using Base::IsFull;
+    public: using Base::Capacity;
+
+
+    public: SortedList(Compare compare=Compare()) : _compare(compare) { };
+
+
+    //**************************************************************************
+    /// Adds an item in its sorted position (after any equal items). Returns
+    /// false if the list is full.
+    //**************************************************************************
+    public: bool Add(const T& item)
+    {
+        Guard guard(*this);
+
+        if (this->_count == _list_size) return false;
+
+        this->InsertAt(Upper(item), item);
+
+        return true;
+    }
+
+
+    public: bool Add(T&& item)
+    {
+        Guard guard(*this);
+
+        if (this->_count == _list_size) return false;
+
+        this->InsertAt(Upper(item), Move(item));
+
+        return true;
+    }
+
+
+    //**************************************************************************
+    /// Adds a batch of items. The batch is sorted in place (with StableSort(),
+    /// so equal items keep their order) and then merged with the list in one
+    /// pass from the end, so each existing item is moved at most once. Batch
+    /// items go after list items that compare equal to them. Either all of the
+    /// items are added or, if there is not enough room, none of them are (and
+    /// false is returned).
+    //**************************************************************************
+    public: bool InsertRange(T* items, size_t count)
+    {
+        StableSort(items, count, _compare);
+
+        Guard guard(*this);
+
+        Index n = this->_count;
+
+        if (count > size_t(_list_size - n)) return false;
+
+        // Merge backward into [0, n + count). Slots at or beyond n are not yet
+        // constructed; those below n hold (possibly moved-from) items.
+        size_t a = n;               // Unmerged list items are [0, a)
+        size_t b = count;           // Unmerged batch items are [0, b)
+
+        for (size_t w = n + count; b > 0; )
+        {
+            w--;
+
+            T* target = this->Slot(w);
+            bool fromList = (a > 0 && _compare(items[b - 1], *this->Slot(a - 1)));
+            T& source = fromList ? *this->Slot(--a) : items[--b];
+
+            if (w >= n)
+                new (target) T(Move(source));
+            else
+                *target = Move(source);
+        }
+
+        this->SetCount(n + count);
+
+        return true;
+    }
+
+
+    //**************************************************************************
+    /// Removes the first item equal to item (i.e. neither orders before the
+    /// other). Returns false if there is no such item.
+    //**************************************************************************
+    public: bool Remove(const T& item)
+    {
+        Guard guard(*this);
+
+        Index i = Lower(item);
+
+        if (i == this->_count || _compare(item, *this->Slot(i))) return false;
+
+        Base::RemoveAt(i, NULL);
+
+        return true;
+    }
+
+
+    //**************************************************************************
+    /// Removes the item at the specified index, optionally moving it into item.
+    /// Returns false if the index is out of range.
+    //**************************************************************************
+    public: bool RemoveAt(int index, T* item=NULL)
+    {
+        Guard guard(*this);
+
+        if (index < 0 || size_t(index) >= this->_count) return false;
+
+        Base::RemoveAt(Index(index), item);
+
+        return true;
+    }
+
+
+    //**************************************************************************
+    /// Returns the index of the first item equal to value, or -1 if there is none.
+    //**************************************************************************
+    public: int Find(const T& value)
+    {
+        Guard guard(*this);
+
+        Index i = Lower(value);
+
+        return (i < this->_count && !_compare(value, *this->Slot(i))) ? int(i) : -1;
+    }
+
+
+    public: inline bool Contains(const T& value) { return (Find(value) >= 0); };
+
+
+    //**************************************************************************
+    /// LowerBound() returns the index of the first item that is not less than
+    /// value; UpperBound() returns the index of the first item that is greater
+    /// than value. Both return Count() if there is no such item.
+    //**************************************************************************
+    public: int LowerBound(const T& value) { Guard guard(*this); return Lower(value); };
+
+
+    public: int UpperBound(const T& value) { Guard guard(*this); return Upper(value); };
+
+
+    //**************************************************************************
+    /// Returns the items in the range [low, high), i.e. from the first item that
+    /// is not less than low up to (but excluding) the first item that is not
+    /// less than high. The span refers to the list's own storage, so it is only
+    /// valid until the list is next modified.
+    //**************************************************************************
+    public: Span<const T> Range(const T& low, const T& high)
+    {
+        Guard guard(*this);
+
+        Index first = Lower(low);
+        Index last = Lower(high);
+
+        if (last < first) last = first;
+
+        return Span<const T>(this->Slot(first), last - first);
+    }
+
+
+    // All of the items, in order
+    public: Span<const T> Items()
+    {
+        Guard guard(*this);
+
+        return Span<const T>(this->Slot(0), this->_count);
+    }
+
+
+    public: inline const T& operator[](size_t index) const { return *this->Slot(index); };
+
+
+    private: typedef typename Base::Guard Guard;
+
+
+    // Binary searches (with the lock held)
+    private: Index Lower(const T& value)
+    {
+        Index low = 0, high = this->_count;
+
+        while (low < high)
+        {
+            Index mid = low + (high - low) / 2;
+
+            if (_compare(*this->Slot(mid), value)) low = mid + 1; else high = mid;
+        }
+
+        return low;
+    }
+
+
+    private: Index Upper(const T& value)
+    {
+        Index low = 0, high = this->_count;
+
+        while (low < high)
+        {
+            Index mid = low + (high - low) / 2;
+
+            if (_compare(value, *this->Slot(mid))) high = mid; else low = mid + 1;
+        }
+
+        return low;
+    }
+
+
+    private: Compare _compare;
+};
+
+#endif
@@ -0,0 +1,609 @@
+#pragma once
+#ifndef _RTL_Statistics_h_
+#define _RTL_Statistics_h_
+/*******************************************************************************
+ * Header file for single-pass (streaming) statistics accumulators: mean and
+ * variance, exponential moving average, minimum/maximum, and quantiles.
+ *
+ * Each accumulator is updated one sample at a time (or a block at a time) in
+ * constant time and constant memory, so statistics no longer need the samples
+ * to be buffered for a second pass.
+ *
+ * Accumulators that support Merge() can be combined: each of several instances
+ * accumulates part of the data (e.g. one per thread on the host, or one per
+ * logging period) and merging them gives the same result as accumulating all
+ * of the data in one instance.
+ *
+ * RunningStats and ExponentialAverage work in floating point. IntegerStats and
+ * ShiftAverage are the fixed-point equivalents: their updates use only integer
+ * arithmetic.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include <math.h>
+#include "RTL_Stdlib.h"
+
+
+//******************************************************************************
+/// Mean and variance by Welford's method, which updates the mean and the sum
+/// of squared deviations from it incrementally. Unlike accumulating the sum
+/// and sum of squares, it does not lose precision when the variance is small
+/// compared to the mean. Merge() uses the parallel form of the update due to
+/// Chan et al.
+//******************************************************************************
+template <typename T=float> class RunningStats
+{
+    public: RunningStats() { Reset(); };
+
+    public: void Reset()
+    {
+        _count = 0;
+        _mean = 0;
+        _m2 = 0;
+    };
+
+    public: void Update(T x)
+    {
+        _count++;
+
+        T delta = x - _mean;
+
+        _mean += delta / T(_count);
+        _m2 += delta * (x - _mean);
+    };
+
+    public: void Update(const T* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) Update(samples[i]);
+    };
+
+    public: void Merge(const RunningStats& other)
+    {
+        if (other._count == 0) return;
+
+        uint32_t count = _count + other._count;
+        T delta = other._mean - _mean;
+
+        _mean += delta * T(other._count) / T(count);
+        _m2 += other._m2 + delta * delta * (T(_count) * T(other._count) / T(count));
+        _count = count;
+    };
+
+    public: inline uint32_t Count() const { return _count; };
+
+    public: inline T Mean() const { return _mean; };
+
+    // The population variance (sum of squared deviations / n)
+    public: inline T Variance() const { return (_count > 0) ? _m2 / T(_count) : T(0); };
+
+    // The sample variance (sum of squared deviations / (n - 1))
+    public: inline T SampleVariance() const { return (_count > 1) ? _m2 / T(_count - 1) : T(0); };
+
+    public: inline T StdDev() const { return T(sqrt(Variance())); };
+
+    private: uint32_t _count;
+    private: T _mean;
+    private: T _m2;
+};
+
+
+//******************************************************************************
+/// Mean and variance of integer (or fixed-point) samples, from exact integer
+/// sums of the samples and of their squares. Updates use only integer adds and
+/// one multiply, and Merge() is exact.
+///
+/// Acc must be able to hold the sum of the squares of all of the samples. With
+/// int64_t (the default) that is any number of int16_t samples the count can
+/// hold (2^32 - 1), but only 2^31 uint16_t samples, whose squares are nearly
+/// twice as large. The mean and variance are only converted to floating point
+/// when they are asked for.
+//******************************************************************************
+template <typename T, typename Acc=int64_t> class IntegerStats
+{
+    public: IntegerStats() { Reset(); };
+
+    public: void Reset()
+    {
+        _count = 0;
+        _sum = 0;
+        _sumSquares = 0;
+    };
+
+    public: inline void Update(T x)
+    {
+        _count++;
+        _sum += x;
+        _sumSquares += Acc(x) * x;
+    };
+
+    public: void Update(const T* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) Update(samples[i]);
+    };
+
+    public: void Merge(const IntegerStats& other)
+    {
+        _count += other._count;
+        _sum += other._sum;
+        _sumSquares += other._sumSquares;
+    };
+
+    public: inline uint32_t Count() const { return _count; };
+
+    public: inline Acc Sum() const { return _sum; };
+
+    public: inline Acc SumSquares() const { return _sumSquares; };
+
+    public: inline float Mean() const { return (_count > 0) ? float(_sum) / float(_count) : 0.0f; };
+
+    // The mean truncated to the sample type, computed without floating point
+    public: inline T IntegerMean() const { return (_count > 0) ? T(_sum / Acc(_count)) : T(0); };
+
+    // The population variance, (sumSquares - sum²/n) / n. The sum²/n term is
+    // split as q·sum + r·sum/n (q and r being the quotient and remainder of
+    // sum/n), so the cancelling terms are subtracted exactly in integers and
+    // only the small remainder term is computed in floating point.
+    public: float Variance() const
+    {
+        if (_count == 0) return 0.0f;
+
+        Acc q = _sum / Acc(_count);
+        Acc r = _sum % Acc(_count);
+
+        return (float(_sumSquares - q * _sum) - float(r) * float(_sum) / float(_count)) / float(_count);
+    };
+
+    public: inline float SampleVariance() const
+    {
+        return (_count > 1) ? Variance() * float(_count) / float(_count - 1) : 0.0f;
+    };
+
+    public: inline float StdDev() const { return sqrtf(Variance()); };
+
+    private: uint32_t _count;
+    private: Acc _sum;
+    private: Acc _sumSquares;
+};
+
+
+//******************************************************************************
+/// The running minimum and maximum of the samples.
+//******************************************************************************
+template <typename T> class MinMax
+{
+    public: MinMax() { Reset(); };
+
+    public: void Reset() { _count = 0; };
+
+    public: inline void Update(T x)
+    {
+        if (_count++ == 0)
+            _min = _max = x;
+        else if (x < _min)
+            _min = x;
+        else if (_max < x)
+            _max = x;
+    };
+
+    public: void Update(const T* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) Update(samples[i]);
+    };
+
+    public: void Merge(const MinMax& other)
+    {
+        if (other._count == 0) return;
+
+        if (_count == 0 || other._min < _min) _min = other._min;
+        if (_count == 0 || _max < other._max) _max = other._max;
+
+        _count += other._count;
+    };
+
+    public: inline uint32_t Count() const { return _count; };
+
+    // Min() and Max() are only meaningful when Count() > 0
+    public: inline T Min() const { return _min; };
+
+    public: inline T Max() const { return _max; };
+
+    public: inline T Range() const { return (_count > 0) ? T(_max - _min) : T(0); };
+
+    private: uint32_t _count;
+    private: T _min;
+    private: T _max;
+};
+
+
+//******************************************************************************
+/// An exponential moving average:
+///
+///     value = value + alpha·(x - value)
+///
+/// where 0 < alpha <= 1. Smaller values of alpha average over more samples
+/// (roughly 2/alpha - 1). The first sample initializes the average.
+//******************************************************************************
+template <typename T=float> class ExponentialAverage
+{
+    public: ExponentialAverage(T alpha) : _alpha(alpha) { Reset(); };
+
+    public: void Reset()
+    {
+        _value = 0;
+        _primed = false;
+    };
+
+    public: T Update(T x)
+    {
+        if (_primed)
+            _value += _alpha * (x - _value);
+        else
+        {
+            _value = x;
+            _primed = true;
+        }
+
+        return _value;
+    };
+
+    public: void Process(const T* in, T* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) out[i] = Update(in[i]);
+    };
+
+    public: inline T Value() const { return _value; };
+
+    private: T _alpha;
+    private: T _value;
+    private: bool _primed;
+};
+
+
+//******************************************************************************
+/// The fixed-point equivalent of ExponentialAverage, with alpha = 1/2^_shift.
+/// The average is kept in Acc scaled up by 2^_shift, so it does not lose the
+/// fraction that shifting each update would otherwise discard, and an update
+/// is just an add, a subtract and a shift. Acc must hold a sample value
+/// shifted left by _shift bits.
+//******************************************************************************
+template <typename T, uint8_t _shift, typename Acc=int32_t> class ShiftAverage
+{
+    static_assert(_shift > 0 && _shift < 8 * sizeof(Acc) - 1, "ShiftAverage shift out of range");
+
+    public: ShiftAverage() { Reset(); };
+
+    public: void Reset()
+    {
+        _acc = 0;
+        _primed = false;
+    };
+
+    public: T Update(T x)
+    {
+        if (_primed)
+            _acc += Acc(x) - (_acc >> _shift);
+        else
+        {
+            _acc = Acc(x) * (Acc(1) << _shift);
+            _primed = true;
+        }
+
+        return Value();
+    };
+
+    public: void Process(const T* in, T* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) out[i] = Update(in[i]);
+    };
+
+    public: inline T Value() const { return T(_acc >> _shift); };
+
+    private: Acc _acc;
+    private: bool _primed;
+};
+
+
+//******************************************************************************
+/// Estimates a quantile (e.g. the median for p = 0.5, or the 95th percentile
+/// for p = 0.95) with the P² algorithm of Jain and Chlamtac, which tracks five
+/// markers whose heights are adjusted by piecewise-parabolic interpolation as
+/// samples arrive. It takes a fixed (and small) amount of memory whatever the
+/// number of samples. Until 5 samples have been seen the exact quantile is returned.
+///
+/// P² estimates cannot be merged; use a Histogram where that is needed.
+//******************************************************************************
+template <typename T=float> class P2Quantile
+{
+    public: P2Quantile(T p) : _p(p) { Reset(); };
+
+    public: void Reset()
+    {
+        _count = 0;
+
+        _increment[0] = 0;
+        _increment[1] = _p / 2;
+        _increment[2] = _p;
+        _increment[3] = (1 + _p) / 2;
+        _increment[4] = 1;
+    };
+
+    public: void Update(T x)
+    {
+        if (_count < 5)
+        {
+            _height[_count++] = x;
+
+            if (_count == 5) Start();
+
+            return;
+        }
+
+        _count++;
+
+        // Find the cell containing x, extending the extreme markers if needed
+        uint8_t k;
+
+        if (x < _height[0])
+        {
+            _height[0] = x;
+            k = 0;
+        }
+        else if (!(x < _height[4]))
+        {
+            if (_height[4] < x) _height[4] = x;
+            k = 3;
+        }
+        else
+        {
+            for (k = 0; !(x < _height[k + 1]); k++) ;
+        }
+
+        for (uint8_t i = k + 1; i < 5; i++) _position[i]++;
+        for (uint8_t i = 0; i < 5; i++) _desired[i] += _increment[i];
+
+        // Move the middle markers towards their desired positions
+        for (uint8_t i = 1; i < 4; i++)
+        {
+            T d = _desired[i] - T(_position[i]);
+
+            if ((d >= 1 && _position[i + 1] - _position[i] > 1) || (d <= -1 && _position[i - 1] - _position[i] < -1))
+            {
+                int8_t s = (d > 0) ? 1 : -1;
+                T h = Parabolic(i, s);
+
+                if (!(_height[i - 1] < h && h < _height[i + 1])) h = Linear(i, s);
+
+                _height[i] = h;
+                _position[i] += s;
+            }
+        }
+    };
+
+    public: void Update(const T* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) Update(samples[i]);
+    };
+
+    public: inline uint32_t Count() const { return _count; };
+
+    public: T Value() const
+    {
+        if (_count >= 5) return _height[2];
+        if (_count == 0) return 0;
+
+        T sorted[5];
+
+        CopyN(sorted, _height, _count);
+        Sort(sorted, _count);
+
+        return sorted[size_t(_p * (_count - 1) + T(0.5))];
+    };
+
+    private: void Start()
+    {
+        Sort(_height, 5);
+
+        for (uint8_t i = 0; i < 5; i++)
+        {
+            _position[i] = i;
+            _desired[i] = 4 * _increment[i];
+        }
+    };
+
+    private: T Parabolic(uint8_t i, int8_t s) const
+    {
+        T n0 = T(_position[i - 1]), n1 = T(_position[i]), n2 = T(_position[i + 1]);
+
+        return _height[i] + T(s) / (n2 - n0) *
+               ((n1 - n0 + s) * (_height[i + 1] - _height[i]) / (n2 - n1) +
+                (n2 - n1 - s) * (_height[i] - _height[i - 1]) / (n1 - n0));
+    };
+
+    private: inline T Linear(uint8_t i, int8_t s) const
+    {
+        return _height[i] + T(s) * (_height[i + s] - _height[i]) / T(_position[i + s] - _position[i]);
+    };
+
+    private: T _p;
+    private: uint32_t _count;
+    private: T _height[5];          // Marker heights (the first 5 samples until Start())
+    private: int32_t _position[5];  // Actual marker positions
+    private: T _desired[5];         // Desired marker positions
+    private: T _increment[5];       // Increments of the desired positions per sample
+};
+
+
+//******************************************************************************
+/// Counts samples in _bins equal-width bins spanning [low, high), plus counts of
+/// samples below and above the range, and estimates quantiles from the counts
+/// by interpolating within the bin where the quantile falls. The estimate is
+/// accurate to about one bin width.
+///
+/// Unlike P2Quantile, histograms with the same range and number of bins can be
+/// merged exactly, and one histogram answers any number of quantiles. For
+/// integer sample types Update() uses only integer arithmetic.
+///
+/// The constructor computes the number of bins per unit of input as a 32.32
+/// fixed-point reciprocal (rounded up), so finding a sample's bin needs no
+/// division. For samples of up to 16 bits it takes two 32-bit multiplies, as
+/// in UniformLookupTable; for 32-bit samples a 64-bit multiply and a check
+/// that corrects the rounding at bin edges.
+//******************************************************************************
+template <typename T, uint16_t _bins> class Histogram
+{
+    static_assert(_bins > 0, "Histogram must have at least 1 bin");
+    static_assert(IsFloatingPoint<T>::value || sizeof(T) <= 4, "Histogram supports integer samples of up to 32 bits");
+
+    public: Histogram(T low, T high) : _low(low), _high(high)
+    {
+        // An empty range has no bins to scale to: every sample is then below
+        // or above it, so the scale is never used.
+        if (!(low < high))
+            _scale.q32 = 0;
+        else if (IsFloatingPoint<T>::value)
+            _scale.f = float(_bins) / float(high - low);
+        else
+        {
+            uint64_t range = uint64_t(int64_t(high) - int64_t(low));
+            uint64_t q32 = ((uint64_t(_bins) << 32) + range - 1) / range;
+
+            if (sizeof(T) <= 2)
+            {
+                _scale.q16.whole = uint32_t(q32 >> 16);
+                _scale.q16.fraction = uint16_t(q32);
+            }
+            else
+                _scale.q32 = q32;
+        }
+
+        Reset();
+    };
+
+    public: void Reset()
+    {
+        for (uint16_t i = 0; i < _bins; i++) _counts[i] = 0;
+
+        _below = 0;
+        _above = 0;
+    };
+
+    public: void Update(T x)
+    {
+        if (x < _low)
+            _below++;
+        else if (!(x < _high))
+            _above++;
+        else
+            _counts[BinOf(x, BoolType<IsFloatingPoint<T>::value>(), BoolType<(sizeof(T) <= 2)>())]++;
+    };
+
+    public: void Update(const T* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) Update(samples[i]);
+    };
+
+    //**************************************************************************
+    /// Adds the counts of another histogram to this one. Returns false (and
+    /// does nothing) if the histograms have different ranges.
+    //**************************************************************************
+    public: bool Merge(const Histogram& other)
+    {
+        if (!(other._low == _low && other._high == _high)) return false;
+
+        for (uint16_t i = 0; i < _bins; i++) _counts[i] += other._counts[i];
+
+        _below += other._below;
+        _above += other._above;
+
+        return true;
+    };
+
+    public: uint32_t Count() const
+    {
+        uint32_t count = _below + _above;
+
+        for (uint16_t i = 0; i < _bins; i++) count += _counts[i];
+
+        return count;
+    };
+
+    public: inline uint32_t Bin(uint16_t i) const { return _counts[i]; };
+
+    public: inline uint32_t Below() const { return _below; };
+
+    public: inline uint32_t Above() const { return _above; };
+
+    //**************************************************************************
+    /// Returns the estimated p-quantile, 0 <= p <= 1. If it falls among the
+    /// samples below or above the range, low or high is returned.
+    //**************************************************************************
+    public: T Quantile(float p) const
+    {
+        float rank = p * float(Count());
+
+        if (rank <= float(_below)) return _low;
+
+        rank -= float(_below);
+
+        for (uint16_t i = 0; i < _bins; i++)
+        {
+            if (rank <= float(_counts[i]) && _counts[i] != 0)
+            {
+                float width = (float(_high) - float(_low)) / float(_bins);
+
+                return T(float(_low) + width * (float(i) + rank / float(_counts[i])));
+            }
+
+            rank -= float(_counts[i]);
+        }
+
+        return _high;
+    };
+
+    private: template <bool _narrow> inline uint16_t BinOf(T x, BoolType<true>, BoolType<_narrow>) const
+    {
+        uint16_t i = uint16_t(float(x - _low) * _scale.f);
+
+        return (i < _bins) ? i : _bins - 1;
+    };
+
+    // (dx·scale) >> 32 in 32-bit parts. The scale is rounded up by less than
+    // 2^-32 bins per unit, so the result is too high by less than dx/2^32 bins.
+    // That is below the 1/range gap between a bin edge and the nearest sample
+    // bin position, so the result is exact for ranges of up to 2^16.
+    private: inline uint16_t BinOf(T x, BoolType<false>, BoolType<true>) const
+    {
+        uint32_t dx = uint32_t(int32_t(x) - int32_t(_low));
+
+        return uint16_t((dx * _scale.q16.whole + ((dx * _scale.q16.fraction) >> 16)) >> 16);
+    };
+
+    // For wider ranges the product can be one bin too high at a bin edge, which
+    // a multiply (rather than a division) detects
+    private: inline uint16_t BinOf(T x, BoolType<false>, BoolType<false>) const
+    {
+        uint64_t dx = uint64_t(int64_t(x) - int64_t(_low));
+        uint16_t i = uint16_t((dx * _scale.q32) >> 32);
+
+        if (uint64_t(i) * uint64_t(int64_t(_high) - int64_t(_low)) > dx * _bins) i--;
+
+        return i;
+    };
+
+    private: T _low;
+    private: T _high;
+
+    // Bins per unit of input
+    private: union
+    {
+        float f;
+        uint64_t q32;
+        struct { uint32_t whole; uint16_t fraction; } q16;
+    } _scale;
+
+    private: uint32_t _counts[_bins];
+    private: uint32_t _below;
+    private: uint32_t _above;
+};
+
+#endif
@@ -8,9 +8,18 @@
  * by R. Terry Lessly
  *******************************************************************************/
 #include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
 #include <pins_arduino.h>
 #include <RTL_Streaming.h>
 
+// Placement new (the AVR core only provides it through new.h)
+#if defined(__AVR__)
+#include <new.h>
+#else
+#include <new>
+#endif
+
 
 /*******************************************************************************
  Macro to "stringize" a macro parameter
@@ -32,8 +41,216 @@
 *******************************************************************************/
 #define PTR(x) (reinterpret_cast<uint32_t>(x))
 
+/*******************************************************************************
+ Compile-time type properties used to select the fastest implementation of the
+ array functions below, and the move/forward helpers used by the containers
+*******************************************************************************/
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+#define RTL_IS_TRIVIALLY_COPYABLE(T) __is_trivially_copyable(T)
+#else
+#define RTL_IS_TRIVIALLY_COPYABLE(T) (__has_trivial_copy(T) && __has_trivial_assign(T))
+#endif
+
+//******************************************************************************
+/// True if objects of type T can be copied (or moved) with memcpy/memmove.
+//******************************************************************************
+template <typename T> struct IsTriviallyCopyable { static const bool value = RTL_IS_TRIVIALLY_COPYABLE(T); };
+
+//******************************************************************************
+/// True if T is a scalar (arithmetic, enum, or pointer) type, whose zero value
+/// is all-bits-zero and can therefore be set with memset.
+//******************************************************************************
+template <typename T> struct IsScalar { static const bool value = RTL_IS_TRIVIALLY_COPYABLE(T) && !__is_class(T) && !__is_union(T); };
+
+//******************************************************************************
+/// True if T is a floating point type.
+//******************************************************************************
+template <typename T> struct IsFloatingPoint { static const bool value = false; };
+template <> struct IsFloatingPoint<float> { static const bool value = true; };
+template <> struct IsFloatingPoint<double> { static const bool value = true; };
+template <> struct IsFloatingPoint<long double> { static const bool value = true; };
+
+template <bool B> struct BoolType { };
+
+//******************************************************************************
+/// Selects type T if B is true, otherwise type F (same as std::conditional).
+//******************************************************************************
+template <bool B, typename T, typename F> struct Conditional { typedef T Type; };
+template <typename T, typename F> struct Conditional<false, T, F> { typedef F Type; };
+
+//******************************************************************************
+/// The smallest unsigned integer type that can hold the values 0 to N. Used by
+/// the fixed-size containers for their indexes and counts, so small containers
+/// keep single-byte (and therefore atomic on AVR) bookkeeping.
+//******************************************************************************
+template <size_t N> struct IndexType
+{
+    typedef typename Conditional<(N <= 0xFF), uint8_t, typename Conditional<(N <= 0xFFFF), uint16_t, uint32_t>::Type>::Type Type;
+};
+
+//******************************************************************************
+/// True if N is a (non-zero) power of two.
+//******************************************************************************
+template <size_t N> struct IsPowerOfTwo { static const bool value = (N != 0) && ((N & (N - 1)) == 0); };
+
+//******************************************************************************
+/// Returns the smallest power of two that is greater than or equal to n (n > 0).
+//******************************************************************************
+constexpr size_t _SmearBits(size_t n, uint8_t shift) { return (shift >= 8 * sizeof(size_t)) ? n : _SmearBits(n | (n >> shift), 2 * shift); }
+
+constexpr size_t NextPowerOfTwo(size_t n) { return _SmearBits(n - 1, 1) + 1; }
+
+//******************************************************************************
+/// Returns the base 2 logarithm of n, rounded down (n > 0).
+//******************************************************************************
+constexpr uint8_t Log2(size_t n) { return (n <= 1) ? 0 : 1 + Log2(n >> 1); }
+
+//******************************************************************************
+/// Strips the reference from a type (same as std::remove_reference)
+//******************************************************************************
+template <typename T> struct RemoveReference      { typedef T Type; };
+template <typename T> struct RemoveReference<T&>  { typedef T Type; };
+template <typename T> struct RemoveReference<T&&> { typedef T Type; };
+
+//******************************************************************************
+/// Casts a value to an rvalue reference so that it can be moved from (same as
+/// std::move)
+//******************************************************************************
+template <typename T> inline typename RemoveReference<T>::Type&& Move(T&& t) { return static_cast<typename RemoveReference<T>::Type&&>(t); };
+
+//******************************************************************************
+/// Passes on a forwarding reference argument as the same kind of reference it
+/// was passed as (same as std::forward)
+//******************************************************************************
+template <typename T> inline T&& Forward(typename RemoveReference<T>::Type& t)  { return static_cast<T&&>(t); };
+template <typename T> inline T&& Forward(typename RemoveReference<T>::Type&& t) { return static_cast<T&&>(t); };
+
+
+/*******************************************************************************
+ Array functions
+
+ These deduce array bounds from the array type and are dispatched at compile
+ time: types that can be handled as raw bytes go straight to memset, memcpy or
+ memmove, while everything else uses a plain size_t-indexed loop (which the
+ compiler is free to unroll or vectorize).
+*******************************************************************************/
+
+//******************************************************************************
+/// Sets count elements starting at dest to value. For trivially copyable types
+/// whose value is the same byte repeated (such as 0 or -1) this is a memset.
+//******************************************************************************
+template <typename T> inline bool _IsRepeatedByte(const T& value)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+
+    for (size_t i = 1; i < sizeof(T); i++)
+    {
+        if (p[i] != p[0]) return false;
+    }
+
+    return true;
+}
+
+template <typename T> inline void _FillN(T* dest, size_t count, const T& value, BoolType<false>) { for (size_t i = 0; i < count; i++) dest[i] = value; }
+template <typename T> inline void _FillN(T* dest, size_t count, const T& value, BoolType<true>)
+{
+    if (_IsRepeatedByte(value))
+        memset(dest, *reinterpret_cast<const uint8_t*>(&value), count * sizeof(T));
+    else
+        _FillN(dest, count, value, BoolType<false>());
+}
+
+template <typename T, typename V> inline void FillN(T* dest, size_t count, const V& value)
+{
+    const T v(value);
+
+    _FillN(dest, count, v, BoolType<IsTriviallyCopyable<T>::value>());
+}
+
+//******************************************************************************
+/// Sets count elements starting at dest to zero. Trivially copyable types
+/// (including plain structs) are cleared with memset; other types must have an
+/// assignment operator (operator=) for a numeric type (int, long, etc...)
+//******************************************************************************
+template <typename T> inline void _ZeroN(T* dest, size_t count, BoolType<true>) { memset(dest, 0, count * sizeof(T)); }
+template <typename T> inline void _ZeroN(T* dest, size_t count, BoolType<false>) { for (size_t i = 0; i < count; i++) dest[i] = 0; }
+
+template <typename T> inline void ZeroN(T* dest, size_t count) { _ZeroN(dest, count, BoolType<IsTriviallyCopyable<T>::value>()); }
+
+//******************************************************************************
+/// Copies count elements from srce to dest. The ranges must not overlap.
+//******************************************************************************
+template <typename T> inline void _CopyN(T* dest, const T* srce, size_t count, BoolType<true>) { memcpy(dest, srce, count * sizeof(T)); }
+template <typename T> inline void _CopyN(T* dest, const T* srce, size_t count, BoolType<false>) { for (size_t i = 0; i < count; i++) dest[i] = srce[i]; }
+
+template <typename T> inline void CopyN(T* dest, const T* srce, size_t count) { _CopyN(dest, srce, count, BoolType<IsTriviallyCopyable<T>::value>()); }
+
+// Copies between arrays of different (but assignment compatible) types
+template <typename D, typename S> inline void CopyN(D* dest, const S* srce, size_t count) { for (size_t i = 0; i < count; i++) dest[i] = srce[i]; }
+
+//******************************************************************************
+/// Moves count elements from srce to dest. The ranges may overlap. The moved-from
+/// elements are left in a valid but unspecified state.
+//******************************************************************************
+template <typename T> inline void _MoveN(T* dest, T* srce, size_t count, BoolType<true>) { memmove(dest, srce, count * sizeof(T)); }
+template <typename T> inline void _MoveN(T* dest, T* srce, size_t count, BoolType<false>)
+{
+    if (dest < srce)
+    {
+        for (size_t i = 0; i < count; i++) dest[i] = Move(srce[i]);
+    }
+    else if (dest > srce)
+    {
+        for (size_t i = count; i > 0; i--) dest[i - 1] = Move(srce[i - 1]);
+    }
+}
+
+template <typename T> inline void MoveN(T* dest, T* srce, size_t count) { _MoveN(dest, srce, count, BoolType<IsTriviallyCopyable<T>::value>()); }
+
+//******************************************************************************
+/// Initializes all elements of an array to the same value.
+/// - Assumes that the array element has an assignment operator (operator=) defined 
+///   for typeof(value)
+//******************************************************************************
+template <typename T, size_t N, typename V> inline void InitArray(T (&arr)[N], const V& value) { FillN(arr, N, value); }
+
+//******************************************************************************
+/// Initializes all elements of an array to zero.
+//******************************************************************************
+template <typename T, size_t N> inline void ZeroArray(T (&arr)[N]) { ZeroN(arr, N); }
+
+//******************************************************************************
+/// Initializes all elements of an array to their default value.
+//******************************************************************************
+template <typename T, size_t N> inline void DefaultArray(T (&arr)[N]) { FillN(arr, N, T()); }
+
+//******************************************************************************
+/// Copies all elements of the srce array to dest, which can be an array or a 
+/// pointer to at least as many elements.
+//******************************************************************************
+template <typename D, typename S, size_t N> inline void CopyArray(D* dest, const S (&srce)[N]) { CopyN(dest, static_cast<const S*>(srce), N); }
+
+//******************************************************************************
+/// Shifts all elements of the array 1 position to the left (toward the first 
+/// element). The prior first element is lost; the last element is unchanged.
+//******************************************************************************
+template <typename T, size_t N> inline void ShiftArrayLeft(T (&arr)[N]) { MoveN(arr, arr + 1, N - 1); }
+
+//******************************************************************************
+/// Shifts all elements of the array 1 position to the right (toward the last 
+/// element). The prior last element is lost; the first element is unchanged.
+//******************************************************************************
+template <typename T, size_t N> inline void ShiftArrayRight(T (&arr)[N]) { MoveN(arr + 1, arr, N - 1); }
+
+inline void ZeroMemory(uint8_t* dest, int length) { if (length > 0) memset(dest, 0, length); }
+inline void CopyMemory(uint8_t* dest, const uint8_t* srce, int length) { if (length > 0) memcpy(dest, srce, length); }
+
+
 /*******************************************************************************
  Helper macros for arrays
+
+ These are retained for existing code and are now thin wrappers around the
+ array functions above (so each argument is evaluated only once).
 *******************************************************************************/
 
 //******************************************************************************
@@ -43,29 +260,19 @@
 #define ARRAY_LENGTH(arr) (sizeof(arr)/sizeof(*arr))
 
 //******************************************************************************
-/// Initializes all element of an array to the same value. 
-/// - Assumes that arr is an actual array and not a pointer
-/// - Assumes that the array element has an assignment operator (operator=) defined 
-///   for typeof(value)
+/// Initializes all element of an array to the same value (see InitArray). 
 //******************************************************************************
-#define INIT_ARRAY(arr, value) if (true) { for (int i=0; i < ARRAY_LENGTH(arr); arr[i++] = value);} else (void)0
+#define INIT_ARRAY(arr, value) InitArray(arr, value)
 
 //******************************************************************************
-/// Initializes all element of an array to zero. 
-/// - Assumes that arr is an actual array and not a pointer
-/// - Assumes that the array element has an assignment operator (operator=) 
-///   defined for a numeric type (int, long, etc...)
+/// Initializes all element of an array to zero (see ZeroArray). 
 //******************************************************************************
-#define ZERO_ARRAY(arr) if (true) { for (int i=0; i < ARRAY_LENGTH(arr); arr[i++] = 0);} else (void)0
-inline void ZeroMemory(uint8_t* dest, int length) { while (length-- > 0) *dest++ = 0; }
+#define ZERO_ARRAY(arr) ZeroArray(arr)
 
 //******************************************************************************
-/// Initializes all element of an array to their default value. 
-/// - Assumes that arr is an actual array and not a pointer
-/// - Assumes that the array element has a default no-arg constructor
-/// - Assumes that the array element has a default assignment operator
+/// Initializes all element of an array to their default value (see DefaultArray). 
 //******************************************************************************
-#define DEFAULT_ARRAY(arr) if (true) { for (int i=0; i < ARRAY_LENGTH(arr); Default(arr[i++]));} else (void)0
+#define DEFAULT_ARRAY(arr) DefaultArray(arr)
 
 //******************************************************************************
 /// Returns the last valid index value for the array. 
@@ -80,41 +287,27 @@ inline void ZeroMemory(uint8_t* dest, int length) { while (length-- > 0) *dest++
 #define LAST_ELEMENT(arr) arr[LAST_INDEX(arr)]
 
 //******************************************************************************
-/// Shifts all elements of the array 1 position to the left (toward the first element).
-/// The prior first element is lost as a result of this operation. 
-/// - Assumes that arr is an actual array and not a pointer
-/// - Assumes that a copy assignment operator exists for array elements
+/// Shifts all elements of the array 1 position to the left (see ShiftArrayLeft).
 //******************************************************************************
-#define SHIFT_ARRAY_LEFT(arr) if (true) { for (int i=1; i < ARRAY_LENGTH(arr); arr[i-1] = arr[i], i++);} else (void)0
+#define SHIFT_ARRAY_LEFT(arr) ShiftArrayLeft(arr)
 
 //******************************************************************************
-/// Shifts all elements of the array 1 position to the right (toward the last element). 
-/// The prior last element is lost as a result of this operation. 
-/// - Assumes that arr is an actual array and not a pointer
-/// - Assumes that a copy assignment operator exists for array elements
+/// Shifts all elements of the array 1 position to the right (see ShiftArrayRight).
 //******************************************************************************
-#define SHIFT_ARRAY_RIGHT(arr) if (true) { for (int i=0; i < LAST_INDEX(arr); arr[i+1] = arr[i], i++);} else (void)0
+#define SHIFT_ARRAY_RIGHT(arr) ShiftArrayRight(arr)
 
 //******************************************************************************
-/// Copies all elements of the srce array to the dest array. 
-/// - Assumes that the srce array is an actual array and not a pointer
-/// - The dest argument can be an actual array or a pointer
-/// - Assumes that the srce and dest arrays are the same size and type (or compatible
-///   types)
-/// - Assumes that a copy assignment operator exists for array elements
+/// Copies all elements of the srce array to the dest array (see CopyArray). 
 //******************************************************************************
-#define COPY_ARRAY(dest, srce) if (true) { for (int i=0; i < ARRAY_LENGTH(srce); i++) dest[i] = srce[i];} else (void)0
+#define COPY_ARRAY(dest, srce) CopyArray(dest, srce)
 
 //******************************************************************************
-/// Copies all elements of the srce array to the dest array, where srce array variable
-/// is a pointer (so array length cannot be implicitly determined). 
-/// - Both srce and dest arguments can be an actual array or a pointer
-/// - Assumes that the srce and dest arrays are the same type (or compatible types)
-/// - Assumes that the srce and dest arrays are the size specified by length argument
-/// - Assumes that a copy assignment operator exists for array elements
+/// Copies length elements of the srce array to the dest array, where srce array 
+/// variable is a pointer (so array length cannot be implicitly determined) (see 
+/// CopyN).
 //******************************************************************************
-#define COPY_ARRAY_PTR(dest, srce, length) if (true) { for (int i=0; i < (length);  (dest)[i] = (srce)[i],i++); } else (void)0
-inline void CopyMemory(uint8_t* dest, const uint8_t* srce, int length) { while (length-- > 0) *dest++ = *srce++; }
+#define COPY_ARRAY_PTR(dest, srce, length) CopyN(dest, srce, length)
+
 
 /*******************************************************************************
  Handy functions
@@ -123,17 +316,128 @@ inline void CopyMemory(uint8_t* dest, const uint8_t* srce, int length) { while (
 
 //******************************************************************************
 /// Swaps the value  of 2 instances of type T
-/// - Assumes that type T has a copy constructor
-/// - Assumes that type T has a default assignment operator
+/// - Assumes that type T has a move (or copy) constructor
+/// - Assumes that type T has a move (or copy) assignment operator
 //******************************************************************************
-template <typename T> inline void swap(T& lhs, T& rhs) { T temp(lhs); lhs = rhs; rhs = temp; };
+template <typename T> inline void swap(T& lhs, T& rhs) { T temp(Move(lhs)); lhs = Move(rhs); rhs = Move(temp); };
+
+//******************************************************************************
+/// Compares two values with operator< (same as std::less). This is the default
+/// ordering for Sort() and SortedList.
+//******************************************************************************
+template <typename T> struct Less
+{
+    inline bool operator()(const T& lhs, const T& rhs) const { return lhs < rhs; };
+};
+
+//******************************************************************************
+/// Sorts count items in place into the order given by compare. Small arrays use
+/// insertion sort; larger ones use heapsort, which needs no extra memory and is
+/// O(n log n) in the worst case.
+///
+/// The sort is only stable (keeping equal items in their original order) for
+/// up to 16 items, since heapsort is not stable.
+//******************************************************************************
+template <typename T, typename Compare> void _SiftDown(T* items, size_t root, size_t count, Compare compare)
+{
+    for (size_t child = 2 * root + 1; child < count; root = child, child = 2 * root + 1)
+    {
+        if (child + 1 < count && compare(items[child], items[child + 1])) child++;
+
+        if (!compare(items[root], items[child])) break;
+
+        swap(items[root], items[child]);
+    }
+}
+
+template <typename T, typename Compare> void Sort(T* items, size_t count, Compare compare)
+{
+    if (count <= 16)
+    {
+        for (size_t i = 1; i < count; i++)
+        {
+            for (size_t j = i; j > 0 && compare(items[j], items[j - 1]); j--) swap(items[j], items[j - 1]);
+        }
+
+        return;
+    }
+
+    for (size_t i = count / 2; i > 0; i--) _SiftDown(items, i - 1, count, compare);
+
+    for (size_t end = count - 1; end > 0; end--)
+    {
+        swap(items[0], items[end]);
+        _SiftDown(items, 0, end, compare);
+    }
+}
+
+template <typename T> inline void Sort(T* items, size_t count) { Sort(items, count, Less<T>()); }
+
+//******************************************************************************
+/// Sorts count items in place into the order given by compare, keeping equal
+/// items in their original order. This is a binary insertion sort: it makes
+/// O(n log n) comparisons but may move O(n²) items (a memmove per item for
+/// trivially copyable types), so it suits the short batches it is used for.
+//******************************************************************************
+template <typename T, typename Compare> void StableSort(T* items, size_t count, Compare compare)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        // Find the first of the sorted items [0, i) that orders after items[i]
+        size_t lo = 0, hi = i;
+
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+
+            if (compare(items[i], items[mid])) hi = mid; else lo = mid + 1;
+        }
+
+        if (lo == i) continue;
+
+        T item(Move(items[i]));
+
+        MoveN(items + lo + 1, items + lo, i - lo);
+        items[lo] = Move(item);
+    }
+}
+
+template <typename T> inline void StableSort(T* items, size_t count) { StableSort(items, count, Less<T>()); }
+
+//******************************************************************************
+/// A non-owning view of a contiguous run of items (like std::span), used to
+/// return ranges of a container without copying them. A span is only valid
+/// until the container it refers to is modified.
+//******************************************************************************
+template <typename T> class Span
+{
+    public: Span() : _data(NULL), _length(0) { };
+
+    public: Span(T* data, size_t length) : _data(data), _length(length) { };
+
+    public: inline T* Data() const { return _data; };
+
+    public: inline size_t Length() const { return _length; };
+
+    public: inline bool IsEmpty() const { return (_length == 0); };
+
+    public: inline T& operator[](size_t index) const { return _data[index]; };
+
+    // For range-based for loops
+    public: inline T* begin() const { return _data; };
+
+    public: inline T* end() const { return _data + _length; };
+
+    private: T* _data;
+    private: size_t _length;
+};
 
 //******************************************************************************
 /// Sets an instance of type T to its default value
 /// - Assumes that type T has a default no-arg constructor
 /// - Assumes that type T has a default assignment operator
 //******************************************************************************
-template <typename T> inline void Default(T& a) { T b(); a = b; };
+template <typename T> inline void Default(T& a) { a = T(); };
 
 
 /*******************************************************************************
@@ -0,0 +1,187 @@
+/*******************************************************************************
+ This module implements the Task and TaskScheduler classes. See RTL_Task.h for
+ an overview.
+
+ Each task is on at most one of the scheduler's lists: ready (to run next tick),
+ running (still to run this tick), or waiting (on a queue). Sleeping tasks are on
+ no list at all - only their timer is on the TimerWheel.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Task.h"
+
+
+Task::Task()
+    : _taskLine(0), _next(NULL), _scheduler(NULL), _status(TaskStatus::Stopped), _timer(&Task::Wake, this),
+      _waitCondition(NULL), _waitObject(NULL)
+{
+}
+
+
+void Task::Sleep(uint32_t ms)
+{
+    _status = TaskStatus::Sleeping;
+    _scheduler->_timers.Schedule(_timer, ms);
+}
+
+
+void Task::Wake(void* arg)
+{
+    Task* task = static_cast<Task*>(arg);
+
+    if (task->_status == TaskStatus::Sleeping) task->_scheduler->MakeReady(task);
+}
+
+
+void TaskScheduler::Start(Task& task)
+{
+    // A task restarting itself is restarted when its Run() returns, as the wait
+    // macro it returns through would overwrite _taskLine and _status
+    if (&task == _current)
+    {
+        _request = Request::Restart;
+        return;
+    }
+
+    Stop(task);
+
+    task._taskLine = 0;
+    task._scheduler = this;
+
+    MakeReady(&task);
+}
+
+
+void TaskScheduler::Stop(Task& task)
+{
+    if (task._scheduler != this) return;
+
+    // Likewise a task stopping itself is stopped when its Run() returns
+    if (&task == _current)
+    {
+        _request = Request::Stop;
+        return;
+    }
+
+    Unlink(&task);
+    _timers.Cancel(task._timer);
+    task._status = TaskStatus::Stopped;
+}
+
+
+void TaskScheduler::Tick()
+{
+    // Wake any sleeping tasks whose timers have expired
+    _timers.Update();
+
+    // Wake any waiting tasks whose queues now have items
+    for (Task** link = &_waiting; *link != NULL; )
+    {
+        Task* task = *link;
+
+        if (task->_waitCondition(task->_waitObject))
+        {
+            *link = task->_next;
+            MakeReady(task);
+        }
+        else
+        {
+            link = &task->_next;
+        }
+    }
+
+    // Run each task that is ready at the start of this tick once. Tasks made
+    // ready while this is going on (including the ones run here that are still
+    // ready) will run on the next tick.
+    _running = _ready;
+    _ready = _readyTail = NULL;
+
+    while (_running != NULL)
+    {
+        Task* task = _running;
+
+        _running = task->_next;
+        task->_next = NULL;
+
+        _current = task;
+        task->Run();
+        _current = NULL;
+
+        if (_request != Request::None)
+        {
+            // Undo any wait the task started after calling Start() or Stop()
+            _timers.Cancel(task->_timer);
+            task->_status = TaskStatus::Stopped;
+
+            if (_request == Request::Restart)
+            {
+                task->_taskLine = 0;
+                MakeReady(task);
+            }
+
+            _request = Request::None;
+            continue;
+        }
+
+        switch (task->_status)
+        {
+            case TaskStatus::Ready:
+                MakeReady(task);
+                break;
+
+            case TaskStatus::Waiting:
+                task->_next = _waiting;
+                _waiting = task;
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+
+void TaskScheduler::MakeReady(Task* task)
+{
+    task->_status = TaskStatus::Ready;
+    task->_next = NULL;
+
+    if (_readyTail != NULL)
+        _readyTail->_next = task;
+    else
+        _ready = task;
+
+    _readyTail = task;
+}
+
+
+void TaskScheduler::Unlink(Task* task)
+{
+    if (Unlink(&_ready, task))
+    {
+        // Fix up the tail if the last task was removed
+        _readyTail = _ready;
+
+        while (_readyTail != NULL && _readyTail->_next != NULL) _readyTail = _readyTail->_next;
+    }
+    else if (!Unlink(&_running, task))
+    {
+        Unlink(&_waiting, task);
+    }
+}
+
+
+bool TaskScheduler::Unlink(Task** list, Task* task)
+{
+    for (Task** link = list; *link != NULL; link = &(*link)->_next)
+    {
+        if (*link == task)
+        {
+            *link = task->_next;
+            task->_next = NULL;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,173 @@
+#pragma once
+#ifndef _RTL_Task_h_
+#define _RTL_Task_h_
+/*******************************************************************************
+ * Header file for the Task and TaskScheduler classes (stackless cooperative
+ * tasks).
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_TimerWheel.h"
+
+
+//******************************************************************************
+/// Macros used to write the body of a task. A task is written as a straight-line
+/// sequence in its Run() method, bracketed by TASK_BEGIN() and TASK_END():
+///
+///     class MotorRamp : public Task
+///     {
+///         protected: void Run()
+///         {
+///             TASK_BEGIN();
+///             for (_speed = 0; _speed < 255; _speed += 5)
+///             {
+///                 analogWrite(MOTOR_PIN, _speed);
+///                 TASK_AWAIT_MS(20);
+///             }
+///             TASK_AWAIT_QUEUE(_commands, _command);
+///             ...
+///             TASK_END();
+///         }
+///
+///         private: uint8_t _speed;        // Locals that live across waits must be members
+///     };
+///
+/// These are protothread-style macros: Run() returns at each wait point and the
+/// next call resumes right after it (via a switch on the saved source line). So a
+/// task needs no stack of its own, but local variables are NOT preserved across a
+/// wait, a wait cannot appear inside a switch statement, and only one wait macro
+/// may appear per source line.
+///
+/// TASK_YIELD()                 Lets other tasks run, then resumes on the next scheduler tick.
+/// TASK_AWAIT_MS(ms)            Sleeps for the given number of milliseconds.
+/// TASK_AWAIT_QUEUE(queue, x)   Waits until an item can be removed from the queue into x.
+/// TASK_AWAIT_UNTIL(condition)  Yields until the condition is true (re-evaluated every tick).
+///
+/// Only TASK_AWAIT_MS() costs nothing while it waits. Waiting is otherwise polled
+/// once per scheduler tick: TASK_AWAIT_QUEUE() checks the queue's IsEmpty() (the
+/// task body is not re-entered until it has an item), and TASK_AWAIT_UNTIL()
+/// re-enters Run() to evaluate its condition, so prefer the other two where they
+/// fit.
+///
+/// A task may call Start() or Stop() on itself from its own Run(). That takes
+/// effect when Run() returns, so whatever the task does after the call (such as
+/// a wait macro saving its resume point) is discarded.
+//******************************************************************************
+#define TASK_BEGIN()                  switch (_taskLine) { case 0:
+
+#define TASK_YIELD()                  do { _taskLine = __LINE__; return; case __LINE__:; } while (0)
+
+#define TASK_AWAIT_MS(ms)             do { _taskLine = __LINE__; Sleep(ms); return; case __LINE__:; } while (0)
+
+#define TASK_AWAIT_QUEUE(queue, item) do { _taskLine = __LINE__; case __LINE__: if (!(queue).Remove(item)) { WaitFor(queue); return; } } while (0)
+
+#define TASK_AWAIT_UNTIL(condition)   do { _taskLine = __LINE__; case __LINE__: if (!(condition)) return; } while (0)
+
+#define TASK_END()                    } _taskLine = 0; Finish(); return
+
+
+class TaskScheduler;
+
+
+enum class TaskStatus : uint8_t
+{
+    Stopped,        // Not started, or finished
+    Ready,          // Will run on the next scheduler tick
+    Sleeping,       // Waiting for a timer; costs nothing until it expires
+    Waiting         // Waiting for a queue to become non-empty; polled each tick
+};
+
+
+//******************************************************************************
+/// Base class for a cooperative task. Derive from it and implement Run() using
+/// the TASK_xxx macros above, then start it on a TaskScheduler.
+//******************************************************************************
+class Task
+{
+    public: Task();
+
+    public: inline TaskStatus Status() const { return _status; };
+
+    public: inline bool IsRunning() const { return (_status != TaskStatus::Stopped); };
+
+    //**************************************************************************
+    /// The body of the task. It is called once per scheduler tick while the task
+    /// is ready, and resumes where it left off at the last wait point.
+    //**************************************************************************
+    protected: virtual void Run() = 0;
+
+    protected: void Sleep(uint32_t ms);
+
+    protected: template <typename Q> void WaitFor(Q& queue)
+    {
+        _waitCondition = &QueueHasItems<Q>;
+        _waitObject = &queue;
+        _status = TaskStatus::Waiting;
+    }
+
+    protected: inline void Finish() { _status = TaskStatus::Stopped; };
+
+    protected: uint16_t _taskLine;      // Resume point, managed by the TASK_xxx macros
+
+    private: template <typename Q> static bool QueueHasItems(void* queue) { return !static_cast<Q*>(queue)->IsEmpty(); }
+
+    private: static void Wake(void* task);
+
+    private: friend class TaskScheduler;
+
+    private: Task* _next;
+    private: TaskScheduler* _scheduler;
+    private: TaskStatus _status;
+    private: Timer _timer;
+    private: bool (*_waitCondition)(void*);
+    private: void* _waitObject;
+};
+
+
+//******************************************************************************
+/// Runs a set of cooperative tasks from a single call to Tick() in loop().
+///
+/// Only ready tasks are run. A sleeping task is parked on the TimerWheel and is
+/// not touched again until its timer expires. A task waiting on a queue is not
+/// run until the queue has an item, but it is polled for that: each tick costs
+/// one IsEmpty() call per waiting task (the task body itself is not re-entered).
+///
+/// The scheduler shares the caller's TimerWheel, and Tick() also calls its
+/// Update(), so other timers on the same wheel keep working.
+//******************************************************************************
+class TaskScheduler
+{
+    public: TaskScheduler(TimerWheel& timers) : _timers(timers), _ready(NULL), _readyTail(NULL), _running(NULL), _waiting(NULL), _current(NULL), _request(Request::None) { };
+
+    // Starts (or restarts from the beginning) a task. Called by a task on
+    // itself, the restart takes effect when its Run() returns.
+    public: void Start(Task& task);
+
+    // Stops a task; it can be started again later from the beginning. Called by
+    // a task on itself, it takes effect when its Run() returns.
+    public: void Stop(Task& task);
+
+    // Updates the timer wheel and runs each ready task once
+    public: void Tick();
+
+    public: inline TimerWheel& Timers() { return _timers; };
+
+    private: void MakeReady(Task* task);
+    private: void Unlink(Task* task);
+    private: static bool Unlink(Task** list, Task* task);
+
+    // What the current task asked for, by calling Start() or Stop() on itself
+    private: enum class Request : uint8_t { None, Restart, Stop };
+
+    private: friend class Task;
+
+    private: TimerWheel& _timers;
+    private: Task* _ready;
+    private: Task* _readyTail;
+    private: Task* _running;            // Tasks still to be run in the current tick
+    private: Task* _waiting;
+    private: Task* _current;            // The task whose Run() is executing
+    private: Request _request;          // Applied to _current when its Run() returns
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*******************************************************************************
+ This module implements the hierarchical TimerWheel. See RTL_TimerWheel.h for
+ an overview.
+
+ The wheel time (_now) is the next tick to be processed. A timer is filed in
+ the lowest level whose span covers the time remaining until it expires, in the
+ slot selected by the corresponding bits of its expiry time. Each time the
+ level 0 index wraps to zero, the current slot of level 1 is cascaded (its
+ timers re-filed relative to the new time), and so on up the levels. By the
+ time a timer reaches level 0 its slot is exactly its expiry tick.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_TimerWheel.h"
+#include "RTL_Lock.h"
+
+
+static const uint8_t SLOT_MASK = TimerWheel::Slots - 1;
+
+// Saves and restores the interrupt state, so the wheel can be updated from code
+// that already has interrupts disabled (e.g. Tick() from a timer ISR)
+static InterruptLock wheelLock;
+
+
+TimerWheel::TimerWheel() : _now(0), _lastMillis(millis())
+{
+    for (uint8_t level = 0; level < Levels; level++)
+    {
+        for (uint8_t slot = 0; slot < Slots; slot++) _wheel[level][slot] = NULL;
+    }
+}
+
+
+void TimerWheel::Schedule(Timer& timer, uint32_t delay, uint32_t period)
+{
+    InterruptLock::Guard guard(wheelLock);  // ATOMIC BLOCK BEGIN
+
+    if (timer._link != NULL) Unlink(&timer);
+
+    timer._expires = _now + delay;
+    timer._period = period;
+    Insert(&timer);
+}                                           // ATOMIC BLOCK END
+
+
+void TimerWheel::Cancel(Timer& timer)
+{
+    InterruptLock::Guard guard(wheelLock);  // ATOMIC BLOCK BEGIN
+
+    if (timer._link != NULL) Unlink(&timer);
+
+    // If the timer is sitting in the dispatch queue, Dispatch() will skip it
+    timer._pending = false;
+}                                           // ATOMIC BLOCK END
+
+
+void TimerWheel::Insert(Timer* timer)
+{
+    uint32_t delta = timer->_expires - _now;
+    uint8_t level = 0;
+    uint8_t slot;
+
+    if (int32_t(delta) < 0)
+    {
+        // Already expired - fire on the next tick
+        slot = _now & SLOT_MASK;
+    }
+    else
+    {
+        uint32_t expires = timer->_expires;
+
+        while (level < Levels - 1 && delta >= (uint32_t(1) << (SlotBits * (level + 1)))) level++;
+
+        // Beyond the range of the wheel, park it in the top level until it gets closer
+        if (delta >= (uint32_t(1) << (SlotBits * Levels))) expires = _now + ((uint32_t(1) << (SlotBits * Levels)) - 1);
+
+        slot = (expires >> (SlotBits * level)) & SLOT_MASK;
+    }
+
+    Timer** head = &_wheel[level][slot];
+
+    timer->_next = *head;
+    timer->_link = head;
+
+    if (*head != NULL) (*head)->_link = &timer->_next;
+
+    *head = timer;
+}
+
+
+void TimerWheel::Unlink(Timer* timer)
+{
+    *timer->_link = timer->_next;
+
+    if (timer->_next != NULL) timer->_next->_link = timer->_link;
+
+    timer->_next = NULL;
+    timer->_link = NULL;
+}
+
+
+void TimerWheel::Cascade(uint8_t level, uint8_t slot)
+{
+    Timer* timer = _wheel[level][slot];
+
+    _wheel[level][slot] = NULL;
+
+    while (timer != NULL)
+    {
+        Timer* next = timer->_next;
+
+        timer->_link = NULL;
+        Insert(timer);
+        timer = next;
+    }
+}
+
+
+void TimerWheel::Tick()
+{
+    uint8_t index = _now & SLOT_MASK;
+
+    if (index == 0)
+    {
+        for (uint8_t level = 1; level < Levels; level++)
+        {
+            uint8_t slot = (_now >> (SlotBits * level)) & SLOT_MASK;
+
+            Cascade(level, slot);
+
+            if (slot != 0) break;
+        }
+    }
+
+    Timer* timer = _wheel[0][index];
+
+    _wheel[0][index] = NULL;
+    _now = _now + 1;
+
+    while (timer != NULL)
+    {
+        Timer* next = timer->_next;
+
+        timer->_next = NULL;
+        timer->_link = NULL;
+
+        if (timer->_period != 0)
+        {
+            timer->_expires += timer->_period;
+            Insert(timer);
+        }
+
+        if (!timer->_pending)
+        {
+            if (_expired.Add(timer))
+            {
+                timer->_pending = true;
+            }
+            else if (timer->_period == 0)
+            {
+                // Dispatch queue is full - retry a one-shot timer on the next tick.
+                // (A periodic timer just misses this expiry.)
+                timer->_expires = _now;
+                Insert(timer);
+            }
+        }
+
+        timer = next;
+    }
+}
+
+
+void TimerWheel::Dispatch()
+{
+    Timer* timer;
+
+    while (_expired.Remove(timer))
+    {
+        bool cancelled;
+
+        {
+            InterruptLock::Guard guard(wheelLock);  // ATOMIC BLOCK BEGIN
+            cancelled = !timer->_pending;
+            timer->_pending = false;
+        }                                           // ATOMIC BLOCK END
+
+        if (!cancelled && timer->_callback != NULL) timer->_callback(timer->_arg);
+    }
+}
+
+
+void TimerWheel::Update()
+{
+    uint32_t ms = millis();
+
+    while (_lastMillis != ms)
+    {
+        {
+            InterruptLock::Guard guard(wheelLock);  // ATOMIC BLOCK BEGIN
+            Tick();
+        }                                           // ATOMIC BLOCK END
+
+        _lastMillis++;
+    }
+
+    Dispatch();
+}
@@ -0,0 +1,120 @@
+#pragma once
+#ifndef _RTL_TimerWheel_h_
+#define _RTL_TimerWheel_h_
+/*******************************************************************************
+ * Header file for the Timer and TimerWheel classes.
+ *******************************************************************************/
+#include <inttypes.h>
+#include <stddef.h>
+#include "RTL_Queue.h"
+
+
+typedef void (*TimerCallback)(void* arg);
+
+
+//******************************************************************************
+/// A software timer that is scheduled on a TimerWheel. Timers are owned by the
+/// caller (typically as globals or class members), so the wheel never allocates
+/// memory. A timer may only be scheduled on one wheel at a time.
+//******************************************************************************
+class Timer
+{
+    public: Timer() : _next(NULL), _link(NULL), _expires(0), _period(0), _callback(NULL), _arg(NULL), _pending(false) { };
+
+    public: Timer(TimerCallback callback, void* arg=NULL)
+        : _next(NULL), _link(NULL), _expires(0), _period(0), _callback(callback), _arg(arg), _pending(false) { };
+
+    public: inline void SetCallback(TimerCallback callback, void* arg=NULL) { _callback = callback; _arg = arg; };
+
+    // Determines if the timer is scheduled to expire (or has expired and is waiting to be dispatched)
+    public: inline bool IsActive() const { return (_link != NULL || _pending); };
+
+    private: friend class TimerWheel;
+
+    private: Timer* _next;              // Next timer in the same wheel slot
+    private: Timer** _link;             // The pointer that points to this timer; NULL when not in the wheel
+    private: uint32_t _expires;         // Wheel tick at which the timer expires
+    private: uint32_t _period;          // Repeat interval in ticks, or 0 for a one-shot timer
+    private: TimerCallback _callback;
+    private: void* _arg;
+    private: volatile bool _pending;    // Expired and queued for dispatch
+};
+
+
+//******************************************************************************
+/// A hierarchical timer wheel driven by millis().
+///
+/// This replaces the common pattern of polling many
+///
+///     if (millis() - last > period) { ... }
+///
+/// checks on every pass through loop(). Scheduling and cancelling a timer are
+/// O(1), and the work done per millisecond tick is O(1) plus the timers that
+/// actually expire (timers further in the future are cascaded down one wheel
+/// level at a time). So loop overhead does not grow with the number of timers.
+///
+/// The wheel has 4 levels of 16 slots with a 1 ms tick, covering 65.5 seconds
+/// directly. Longer delays are parked in the top level and re-filed as they get
+/// closer. All tick arithmetic is unsigned and modulo 2^32, so the wheel is safe
+/// across millis() wraparound.
+///
+/// Expired timers are posted to a Queue and their callbacks are run by Dispatch().
+/// This allows Tick() to be driven from a 1 ms timer interrupt while callbacks
+/// still run in loop(). The simplest usage, though, is just to call Update() in
+/// loop(), which catches the wheel up to millis() and then dispatches.
+//******************************************************************************
+class TimerWheel
+{
+    public: static const uint8_t SlotBits = 4;
+    public: static const uint8_t Slots = 1 << SlotBits;
+    public: static const uint8_t Levels = 4;
+    public: static const uint8_t DispatchQueueSize = 16;
+
+    public: TimerWheel();
+
+    //**************************************************************************
+    /// Schedules a timer to expire after delay milliseconds, and then every period
+    /// milliseconds if period is not zero. Since the current millisecond is already
+    /// partly over, the first expiry is dispatched on the first Update() where at
+    /// least delay whole milliseconds have elapsed. A timer that is already
+    /// scheduled is rescheduled.
+    //**************************************************************************
+    public: void Schedule(Timer& timer, uint32_t delay, uint32_t period=0);
+
+    //**************************************************************************
+    /// Cancels a timer. This also cancels a pending (expired but not yet
+    /// dispatched) callback.
+    //**************************************************************************
+    public: void Cancel(Timer& timer);
+
+    //**************************************************************************
+    /// Advances the wheel by one tick (1 ms), posting any timers that expire to
+    /// the dispatch queue. Call this either from a 1 ms timer interrupt or not at
+    /// all (and use Update() instead).
+    //**************************************************************************
+    public: void Tick();
+
+    //**************************************************************************
+    /// Runs the callbacks of expired timers. Call this from loop().
+    //**************************************************************************
+    public: void Dispatch();
+
+    //**************************************************************************
+    /// Advances the wheel to the current millis() value and then calls Dispatch().
+    //**************************************************************************
+    public: void Update();
+
+    // The current wheel time, in ticks
+    public: inline uint32_t Now() const { return _now; };
+
+    private: void Insert(Timer* timer);
+    private: void Unlink(Timer* timer);
+    private: void Cascade(uint8_t level, uint8_t slot);
+
+    private: Timer* _wheel[Levels][Slots];
+    private: volatile uint32_t _now;            // The next tick to be processed
+    private: uint32_t _lastMillis;
+    private: Queue<Timer*, DispatchQueueSize> _expired;
+};
+
+#endif
@@ -0,0 +1,165 @@
+/*******************************************************************************
+ This module implements the trace recorder enabled by defining RTL_TRACE (see
+ RTL_Trace.h). When it is not defined this module is empty.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Trace.h"
+
+
+#if defined(RTL_TRACE)
+
+#include "RTL_Lock.h"
+#include "RTL_CycleCounter.h"
+
+
+TraceEvent Trace::_events[Trace::Size];
+uint32_t Trace::_head = 0;
+volatile uint8_t Trace::_writers = 0;
+volatile bool Trace::_enabled = true;
+
+
+static_assert(sizeof(TraceEvent) == 8, "TraceEvent must be 8 bytes, as in the dump format");
+
+
+#if defined(RTL_TRACE_CYCLES) && defined(F_CPU)
+static inline uint32_t TraceTime() { return CycleCount(); }
+static const uint32_t TraceTicksPerSecond = F_CPU;
+#elif defined(RTL_TRACE_CYCLES)
+static inline uint32_t TraceTime() { return CycleCount(); }
+static const uint32_t TraceTicksPerSecond = 1000000UL;
+#else
+static inline uint32_t TraceTime() { return micros(); }
+static const uint32_t TraceTicksPerSecond = 1000000UL;
+#endif
+
+
+// Returns the context the caller is running in: 0 for thread mode (loop()),
+// otherwise the number of the active exception on ARM, or 1 on AVR, where an
+// ISR can only be told apart by interrupts being disabled. So on AVR an event
+// recorded by loop() with interrupts disabled (e.g. within an InterruptLock
+// Guard) is reported as being in an ISR.
+static inline uint8_t TraceContext()
+{
+#if defined(__arm__)
+    uint32_t ipsr;
+
+    __asm__ volatile ("mrs %0, ipsr" : "=r" (ipsr));
+
+    ipsr &= 0x1FF;
+
+    return (ipsr > 255) ? 255 : uint8_t(ipsr);
+#elif defined(__AVR__)
+    return (SREG & 0x80) ? 0 : 1;
+#else
+    return 0;
+#endif
+}
+
+
+// Adds to a counter shared with ISRs and returns its previous value. Cores
+// without atomic read-modify-write instructions disable interrupts instead.
+template <typename T> static inline T TraceFetchAdd(volatile T& counter, T delta)
+{
+#if defined(__AVR__) || defined(__ARM_ARCH_6M__)
+    InterruptLock lock;
+    InterruptLock::Guard guard(lock);
+
+    T previous = counter;
+
+    counter = previous + delta;
+
+    return previous;
+#else
+    return __atomic_fetch_add(&counter, delta, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+void Trace::Record(uint16_t id, TraceType type)
+{
+    // Dump() waits for _writers to drop to 0, so it is raised before _enabled
+    // is checked and lowered only once the event is complete
+    TraceFetchAdd(_writers, uint8_t(1));
+
+    if (_enabled)
+    {
+        TraceEvent& event = _events[TraceFetchAdd(_head, uint32_t(1)) & (Size - 1)];
+
+        event.Time = TraceTime();
+        event.Id = id;
+        event.Type = type;
+        event.Context = TraceContext();
+    }
+
+    TraceFetchAdd(_writers, uint8_t(-1));
+}
+
+
+uint32_t Trace::Recorded()
+{
+    InterruptLock lock;
+    InterruptLock::Guard guard(lock);
+
+    return _head;
+}
+
+
+void Trace::Clear()
+{
+    InterruptLock lock;
+    InterruptLock::Guard guard(lock);
+
+    _head = 0;
+}
+
+
+static void WriteLE(Print& stream, uint32_t value, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; i++, value >>= 8) stream.write(uint8_t(value));
+}
+
+
+void Trace::Dump(Print& stream)
+{
+    static const uint8_t Magic[4] = { 'R', 'T', 'L', 'T' };
+
+    bool enabled = _enabled;
+
+    _enabled = false;
+
+    // Let the events being recorded by any ISRs that interrupted this one be
+    // completed. Called from an ISR, Dump() cannot wait for a Record() it has
+    // interrupted, as that only finishes after the ISR returns.
+    if (TraceContext() == 0)
+    {
+#if !defined(__AVR__) && !defined(__ARM_ARCH_6M__)
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+        while (_writers != 0) ;
+    }
+
+    uint32_t recorded = Recorded();
+    uint16_t count = (recorded < Size) ? uint16_t(recorded) : Size;
+
+    stream.write(Magic, sizeof(Magic));
+    WriteLE(stream, 1, 1);
+    WriteLE(stream, sizeof(TraceEvent), 1);
+    WriteLE(stream, count, 2);
+    WriteLE(stream, TraceTicksPerSecond, 4);
+    WriteLE(stream, recorded, 4);
+
+    for (uint32_t i = recorded - count; i != recorded; i++)
+    {
+        const TraceEvent& event = _events[i & (Size - 1)];
+
+        WriteLE(stream, event.Time, 4);
+        WriteLE(stream, event.Id, 2);
+        WriteLE(stream, uint8_t(event.Type), 1);
+        WriteLE(stream, event.Context, 1);
+    }
+
+    _enabled = enabled;
+}
+
+#endif
@@ -0,0 +1,167 @@
+#pragma once
+#ifndef _RTL_Trace_h_
+#define _RTL_Trace_h_
+/*******************************************************************************
+ * Header file for the trace recorder ("flight recorder").
+ *
+ * The recorder keeps the most recent RTL_TRACE_SIZE events in a ring buffer in
+ * RAM. Each event is 8 bytes: a timestamp, an event ID, the event type (begin,
+ * end or instant) and the context it was recorded in (0 for loop(), otherwise
+ * the interrupt). After a fault, or whenever it is convenient, Trace::Dump()
+ * writes the ring to a stream in binary, and the host tool in
+ * extras/trace2chrome.cpp converts the dump into Chrome trace_event JSON, which
+ * can be viewed as a timeline in chrome://tracing or Perfetto. ISRs appear as
+ * separate tracks, so preemption of loop() and jitter are easy to see.
+ *
+ * Tracing is only compiled when RTL_TRACE is defined for the whole build (e.g.
+ * with -DRTL_TRACE); otherwise the TRACE_... macros expand to nothing. Other
+ * build options are:
+ *
+ *  - RTL_TRACE_SIZE, the number of events kept (a power of two, default 256).
+ *
+ *  - RTL_TRACE_CYCLES, to timestamp events with CycleCount() (see
+ *    RTL_CycleCounter.h) rather than micros().
+ *
+ * Event IDs are compile-time constants, normally the values of an enum:
+ *
+ *     enum TraceId : uint16_t { ReadSensors, UpdateFilter, MotorIsr };
+ *
+ *     void loop()
+ *     {
+ *         TRACE_SCOPE(ReadSensors);        // Begins now, ends at the closing }
+ *         ...
+ *         TRACE_INSTANT(UpdateFilter);
+ *     }
+ *
+ * Recording an event does not take a lock. A slot in the ring is reserved with
+ * an atomic increment (or, on cores without atomic read-modify-write, such as
+ * AVR and Cortex-M0, an increment with interrupts disabled for a few cycles),
+ * and the event is then written into its own slot, so ISRs and loop() can
+ * record events concurrently. Dump() pauses recording and waits for events
+ * already being written to be completed, so it never writes a partial event
+ * (unless it is called from an ISR that interrupted one being recorded).
+ *
+ * Dump format (all values little-endian):
+ *
+ *     "RTLT"                  magic
+ *     uint8_t  version        1
+ *     uint8_t  eventSize      8
+ *     uint16_t count          number of events that follow, oldest first
+ *     uint32_t ticksPerSecond timestamp rate (1000000 for micros())
+ *     uint32_t recorded       total events recorded (those beyond count were
+ *                             overwritten)
+ *     count events of { uint32_t time; uint16_t id; uint8_t type; uint8_t context; }
+ *
+ * where type is 'B' (begin), 'E' (end) or 'i' (instant), as in Chrome traces.
+ *******************************************************************************/
+#include <inttypes.h>
+
+
+#if !defined(RTL_TRACE_SIZE)
+#define RTL_TRACE_SIZE 256
+#endif
+
+
+//******************************************************************************
+/// The type of a trace event. The values are the Chrome trace_event phases.
+//******************************************************************************
+enum class TraceType : uint8_t
+{
+    Begin = 'B',
+    End = 'E',
+    Instant = 'i',
+};
+
+
+#if defined(RTL_TRACE)
+
+class Print;
+
+
+struct TraceEvent
+{
+    uint32_t Time;
+    uint16_t Id;
+    TraceType Type;
+    uint8_t Context;
+};
+
+
+//******************************************************************************
+/// The trace recorder. All members are static, since there is one ring for
+/// the whole program; normally it is used through the TRACE_... macros below.
+//******************************************************************************
+class Trace
+{
+    public: static const uint16_t Size = RTL_TRACE_SIZE;
+
+    static_assert(Size > 0 && (Size & (Size - 1)) == 0, "RTL_TRACE_SIZE must be a power of two");
+    static_assert(Size <= 32768, "RTL_TRACE_SIZE must be at most 32768");
+
+    public: static void Record(uint16_t id, TraceType type);
+
+    public: template <uint16_t _id> static inline void Begin() { Record(_id, TraceType::Begin); };
+
+    public: template <uint16_t _id> static inline void End() { Record(_id, TraceType::End); };
+
+    public: template <uint16_t _id> static inline void Instant() { Record(_id, TraceType::Instant); };
+
+    // Recording can be paused, e.g. by a fault handler to preserve the events
+    // leading up to the fault. It is enabled at startup.
+    public: static inline void Enable(bool enable) { _enabled = enable; };
+
+    public: static inline bool IsEnabled() { return _enabled; };
+
+    // The total number of events recorded (including any that have since been
+    // overwritten)
+    public: static uint32_t Recorded();
+
+    public: static void Clear();
+
+    //**************************************************************************
+    /// Writes the ring to a stream in the binary format described above.
+    /// Recording is paused while the ring is written. Called from loop(), it
+    /// first waits for any events that ISRs are recording to be completed.
+    //**************************************************************************
+    public: static void Dump(Print& stream);
+
+    private: static TraceEvent _events[Size];
+    private: static uint32_t _head;
+    private: static volatile uint8_t _writers;  // Record() calls in progress
+    private: static volatile bool _enabled;
+};
+
+
+//******************************************************************************
+/// Records a begin event when constructed and the matching end event when
+/// destroyed, so a block is traced on every path out of it.
+//******************************************************************************
+template <uint16_t _id> class TraceScope
+{
+    public: inline TraceScope() { Trace::Begin<_id>(); };
+
+    public: inline ~TraceScope() { Trace::End<_id>(); };
+
+    private: TraceScope(const TraceScope&) = delete;
+    private: TraceScope& operator=(const TraceScope&) = delete;
+};
+
+
+#define RTL_TRACE_JOIN2(a, b) a##b
+#define RTL_TRACE_JOIN(a, b) RTL_TRACE_JOIN2(a, b)
+
+#define TRACE_BEGIN(id)     Trace::Begin<(id)>()
+#define TRACE_END(id)       Trace::End<(id)>()
+#define TRACE_INSTANT(id)   Trace::Instant<(id)>()
+#define TRACE_SCOPE(id)     TraceScope<(id)> RTL_TRACE_JOIN(_traceScope, __LINE__)
+
+#else
+
+#define TRACE_BEGIN(id)
+#define TRACE_END(id)
+#define TRACE_INSTANT(id)
+#define TRACE_SCOPE(id)
+
+#endif
+
+#endif
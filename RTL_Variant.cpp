@@ -0,0 +1,290 @@
+/*******************************************************************************
+ This module implements the compact binary serialization of variant_t values.
+ See RTL_Variant.h for a description of the encoding.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Variant.h"
+
+
+static const uint8_t TAG_TYPE_MASK = 0x0F;
+static const uint8_t TAG_BOOL_BIT  = 0x10;
+
+
+static inline uint32_t ZigZag(int32_t n)    { return (uint32_t(n) << 1) ^ uint32_t(n >> 31); }
+static inline int32_t  UnZigZag(uint32_t n) { return int32_t(n >> 1) ^ -int32_t(n & 1); }
+
+
+static size_t WriteVarint(uint8_t* p, uint32_t value)
+{
+    size_t length = 0;
+
+    while (value >= 0x80)
+    {
+        p[length++] = uint8_t(value) | 0x80;
+        value >>= 7;
+    }
+
+    p[length++] = uint8_t(value);
+
+    return length;
+}
+
+
+static size_t ReadVarint(const uint8_t* p, size_t size, uint32_t& value)
+{
+    value = 0;
+
+    for (size_t i = 0; i < size && i < 5; i++)
+    {
+        // The 5th byte holds bits 28 to 31, so anything above them is malformed
+        if (i == 4 && (p[i] & 0xF0)) return 0;
+
+        value |= uint32_t(p[i] & 0x7F) << (7 * i);
+
+        if ((p[i] & 0x80) == 0) return i + 1;
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+Encodes into a scratch buffer that is always large enough. All the public
+encoders funnel through here so the format is defined in one place.
+*******************************************************************************/
+static size_t Encode(uint8_t* p, VariantType type, variant_union_t data)
+{
+    uint8_t tag = uint8_t(type) & TAG_TYPE_MASK;
+
+    switch (type)
+    {
+        case VariantType::Long:
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, ZigZag(data.Long));
+
+        case VariantType::Int:
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, ZigZag(data.Int));
+
+        case VariantType::SByte:
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, ZigZag(data.SByte));
+
+        case VariantType::UnsignedLong:
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, data.UnsignedLong);
+
+        case VariantType::UnsignedInt:
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, data.UnsignedInt);
+
+        case VariantType::Byte:
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, data.Byte);
+
+        case VariantType::Char:
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, uint8_t(data.Char));
+
+        case VariantType::Pointer:
+            // Only 32 bits are written (see RTL_Variant.h)
+            if (uintptr_t(uint32_t(uintptr_t(data.Pointer))) != uintptr_t(data.Pointer)) return 0;
+
+            p[0] = tag;
+            return 1 + WriteVarint(p + 1, uint32_t(uintptr_t(data.Pointer)));
+
+        case VariantType::Bool:
+            p[0] = tag | (data.Bool ? TAG_BOOL_BIT : 0);
+            return 1;
+
+        case VariantType::Float:
+        {
+            variant_union_t bits;
+
+            bits.Float = data.Float;
+            p[0] = tag;
+            p[1] = uint8_t(bits.UnsignedLong);
+            p[2] = uint8_t(bits.UnsignedLong >> 8);
+            p[3] = uint8_t(bits.UnsignedLong >> 16);
+            p[4] = uint8_t(bits.UnsignedLong >> 24);
+            return 5;
+        }
+    }
+
+    return 0;
+}
+
+
+size_t EncodeVariant(uint8_t* buffer, size_t size, VariantType type, variant_t value)
+{
+    uint8_t scratch[VARIANT_MAX_ENCODED_SIZE];
+    size_t  length = Encode(scratch, type, value);
+
+    if (length == 0 || length > size) return 0;
+
+    memcpy(buffer, scratch, length);
+
+    return length;
+}
+
+
+size_t EncodeVariant(Print& out, VariantType type, variant_t value)
+{
+    uint8_t scratch[VARIANT_MAX_ENCODED_SIZE];
+    size_t  length = Encode(scratch, type, value);
+
+    return (length > 0) ? out.write(scratch, length) : 0;
+}
+
+
+size_t DecodeVariant(const uint8_t* buffer, size_t size, VariantType& type, variant_t& value)
+{
+    if (size == 0) return 0;
+
+    uint8_t tag = buffer[0];
+    uint32_t n;
+    size_t length;
+
+    type = VariantType(tag & TAG_TYPE_MASK);
+
+    // Only a Bool tag may have a bit set above the type
+    if ((tag & ~TAG_TYPE_MASK) != ((type == VariantType::Bool) ? (tag & TAG_BOOL_BIT) : 0)) return 0;
+
+    switch (type)
+    {
+        case VariantType::Bool:
+            value = variant_t(bool((tag & TAG_BOOL_BIT) != 0));
+            return 1;
+
+        case VariantType::Float:
+        {
+            if (size < 5) return 0;
+
+            variant_union_t bits;
+
+            bits.UnsignedLong = uint32_t(buffer[1])
+                              | (uint32_t(buffer[2]) << 8)
+                              | (uint32_t(buffer[3]) << 16)
+                              | (uint32_t(buffer[4]) << 24);
+            value = variant_t(bits.Float);
+            return 5;
+        }
+
+        default:
+            break;
+    }
+
+    length = ReadVarint(buffer + 1, size - 1, n);
+
+    if (length == 0) return 0;
+
+    switch (type)
+    {
+        case VariantType::Long:         value = variant_t(UnZigZag(n));                 break;
+        case VariantType::Int:          value = variant_t(int16_t(UnZigZag(n)));        break;
+        case VariantType::SByte:        value = variant_t(int8_t(UnZigZag(n)));         break;
+        case VariantType::UnsignedLong: value = variant_t(n);                           break;
+        case VariantType::UnsignedInt:  value = variant_t(uint16_t(n));                 break;
+        case VariantType::Byte:         value = variant_t(uint8_t(n));                  break;
+        case VariantType::Char:         value = variant_t(uint8_t(n));                  break;
+        case VariantType::Pointer:      value = variant_t((void*)uintptr_t(n));         break;
+        default:                        return 0;
+    }
+
+    return 1 + length;
+}
+
+
+bool DecodeVariant(Stream& in, VariantType& type, variant_t& value)
+{
+    uint8_t scratch[VARIANT_MAX_ENCODED_SIZE];
+    size_t  length = 0;
+
+    if (in.readBytes(scratch, 1) != 1) return false;
+
+    length = 1;
+
+    // The tag determines how many more bytes make up the value
+    switch (VariantType(scratch[0] & TAG_TYPE_MASK))
+    {
+        case VariantType::Bool:
+            break;
+
+        case VariantType::Float:
+            if (in.readBytes(scratch + 1, 4) != 4) return false;
+            length += 4;
+            break;
+
+        default:
+            do
+            {
+                if (length == VARIANT_MAX_ENCODED_SIZE) return false;
+                if (in.readBytes(scratch + length, 1) != 1) return false;
+            }
+            while (scratch[length++] & 0x80);
+            break;
+    }
+
+    return DecodeVariant(scratch, length, type, value) == length;
+}
+
+
+size_t EncodeVariants(uint8_t* buffer, size_t size, const VariantType* types, const variant_t* values, size_t count)
+{
+    uint8_t scratch[VARIANT_MAX_ENCODED_SIZE];
+    size_t  length = WriteVarint(scratch, uint32_t(count));
+
+    if (length > size) return 0;
+
+    memcpy(buffer, scratch, length);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t n = EncodeVariant(buffer + length, size - length, types[i], values[i]);
+
+        if (n == 0) return 0;
+
+        length += n;
+    }
+
+    return length;
+}
+
+
+size_t EncodeVariants(Print& out, const VariantType* types, const variant_t* values, size_t count)
+{
+    uint8_t scratch[VARIANT_MAX_ENCODED_SIZE];
+    size_t  length = out.write(scratch, WriteVarint(scratch, uint32_t(count)));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        length += EncodeVariant(out, types[i], values[i]);
+    }
+
+    return length;
+}
+
+
+size_t DecodeVariants(const uint8_t* buffer, size_t size, VariantType* types, variant_t* values, size_t capacity, size_t& count)
+{
+    uint32_t n;
+    size_t   length = ReadVarint(buffer, size, n);
+
+    count = 0;
+
+    if (length == 0 || n > capacity) return 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t itemLength = DecodeVariant(buffer + length, size - length, types[i], values[i]);
+
+        if (itemLength == 0) return 0;
+
+        length += itemLength;
+    }
+
+    count = n;
+
+    return length;
+}
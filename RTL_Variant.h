@@ -3,6 +3,11 @@
 #define _RTL_Variant_h_
 
 #include <inttypes.h>
+#include <stddef.h>
+
+
+class Print;
+class Stream;
 
 
 union variant_union_t
@@ -59,4 +64,87 @@ struct variant_t
     private: variant_union_t Data;
 };
 
+
+/*******************************************************************************
+ Compact binary serialization of variant_t values.
+
+ A variant_t does not carry its own type, so the caller supplies a VariantType
+ tag along with the value. Each value is encoded as a single tag byte followed
+ by the payload:
+
+ - Signed integers (Long, Int, SByte) are zigzag encoded and written as a
+   base-128 varint, so small positive or negative values take 1 or 2 bytes.
+ - Unsigned integers (UnsignedLong, UnsignedInt, Byte, Char) and Pointer are
+   written as a base-128 varint. Pointers are written as 32 bits, which holds
+   any pointer on an Arduino board; on a 64-bit host, a pointer that does not
+   fit is not encoded.
+ - Bool is stored in bit 4 of the tag byte and has no payload.
+ - Float is written as 4 bytes, least significant byte first.
+
+ The low nibble of the tag byte is the VariantType, and the decoders reject a
+ tag with any other bits set (bar bit 4 for Bool). An encoded value is never
+ longer than VARIANT_MAX_ENCODED_SIZE bytes.
+*******************************************************************************/
+enum class VariantType : uint8_t
+{
+    Long,
+    UnsignedLong,
+    Int,
+    UnsignedInt,
+    SByte,
+    Byte,
+    Char,
+    Bool,
+    Float,
+    Pointer
+};
+
+
+#define VARIANT_MAX_ENCODED_SIZE 6
+
+
+//******************************************************************************
+/// Encodes a value into a byte buffer. Returns the number of bytes written, or 
+/// 0 if the buffer is too small or the value cannot be encoded.
+//******************************************************************************
+size_t EncodeVariant(uint8_t* buffer, size_t size, VariantType type, variant_t value);
+
+//******************************************************************************
+/// Encodes a value and writes it to a Print stream. Returns the number of bytes
+/// written.
+//******************************************************************************
+size_t EncodeVariant(Print& out, VariantType type, variant_t value);
+
+//******************************************************************************
+/// Decodes a value from a byte buffer. Returns the number of bytes consumed, or 
+/// 0 if the buffer holds a truncated or malformed value.
+//******************************************************************************
+size_t DecodeVariant(const uint8_t* buffer, size_t size, VariantType& type, variant_t& value);
+
+//******************************************************************************
+/// Reads and decodes a value from a Stream, subject to the stream's timeout. 
+/// Returns false if the stream timed out or held a malformed value.
+//******************************************************************************
+bool DecodeVariant(Stream& in, VariantType& type, variant_t& value);
+
+//******************************************************************************
+/// Encodes an array of values into a byte buffer as a varint item count 
+/// followed by each encoded value. Returns the number of bytes written, or 0 if
+/// the buffer is too small to hold the entire batch.
+//******************************************************************************
+size_t EncodeVariants(uint8_t* buffer, size_t size, const VariantType* types, const variant_t* values, size_t count);
+
+//******************************************************************************
+/// Encodes an array of values in the same format as above and writes them to a 
+/// Print stream. Returns the number of bytes written.
+//******************************************************************************
+size_t EncodeVariants(Print& out, const VariantType* types, const variant_t* values, size_t count);
+
+//******************************************************************************
+/// Decodes a batch written by EncodeVariants(). The number of items decoded is
+/// returned in count. Returns the number of bytes consumed, or 0 if the batch 
+/// is truncated, malformed, or holds more than capacity items.
+//******************************************************************************
+size_t DecodeVariants(const uint8_t* buffer, size_t size, VariantType* types, variant_t* values, size_t capacity, size_t& count);
+
 #endif
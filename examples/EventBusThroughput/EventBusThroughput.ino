@@ -0,0 +1,89 @@
+/*******************************************************************************
+ EventBusThroughput
+
+ Measures how many events per second an EventBus can publish and dispatch as
+ the number of subscribers to a topic grows.
+
+ For each subscriber count, events are published in blocks of QUEUE_SIZE
+ (filling the queue) and then dispatched, for TEST_DURATION ms. The handlers
+ only count the events they receive, so the figures are the overhead of the
+ bus itself: queueing, batched removal and the calls to each subscriber.
+
+ Two rates are printed to Serial for each subscriber count: events published
+ and dispatched per second, and handler calls per second.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include <RTL_EventBus.h>
+
+
+#define MAX_SUBSCRIBERS     8
+#define QUEUE_SIZE          32
+#define TEST_DURATION       2000UL      // ms
+
+
+enum Topic : uint8_t { Sample, TopicCount };
+
+EventBus<uint16_t, TopicCount, MAX_SUBSCRIBERS, QUEUE_SIZE> bus;
+
+volatile uint32_t calls = 0;
+
+
+void OnSample(uint8_t, const uint16_t&, void*)
+{
+    calls++;
+}
+
+
+void Measure(uint8_t subscribers)
+{
+    uint32_t events = 0;
+    uint16_t value = 0;
+
+    calls = 0;
+
+    uint32_t start = micros();
+    uint32_t elapsed;
+
+    do
+    {
+        for (uint8_t i = 0; i < QUEUE_SIZE; i++) bus.Publish(Sample, value++);
+
+        events += bus.Dispatch();
+        elapsed = micros() - start;
+    }
+    while (elapsed < TEST_DURATION * 1000UL);
+
+    Serial.print(F("subscribers="));
+    Serial.print(subscribers);
+    Serial.print(F(" events/s="));
+    Serial.print(uint32_t(events * 1000000.0 / elapsed));
+    Serial.print(F(" handler calls/s="));
+    Serial.print(uint32_t(calls * 1000000.0 / elapsed));
+    Serial.print(F(" dropped="));
+    Serial.println(bus.Dropped());
+}
+
+
+void setup()
+{
+    Serial.begin(115200);
+
+    while (!Serial) ;
+
+    Serial.println(F("EventBus throughput against subscriber count"));
+
+    // Add subscribers one at a time, measuring at each count. The context
+    // pointer makes each subscription distinct.
+    for (uint8_t i = 1; i <= MAX_SUBSCRIBERS; i++)
+    {
+        bus.Subscribe(Sample, OnSample, reinterpret_cast<void*>(uintptr_t(i)));
+
+        Measure(i);
+    }
+}
+
+
+void loop()
+{
+}
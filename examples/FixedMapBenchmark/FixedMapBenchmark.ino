@@ -0,0 +1,102 @@
+/*******************************************************************************
+ FixedMapBenchmark
+
+ Compares the lookup time of a FixedMap with a linear scan of an array of
+ key/value pairs (the usual alternative for small tables), for several table
+ sizes.
+
+ Each table is filled with the same scattered 16-bit IDs, then every key is
+ looked up LOOKUPS times in total, in order. Both tables use NoLock so that
+ only the lookup itself is timed. A linear scan finds a key after examining
+ half of the table on average, while the FixedMap examines about one slot
+ whatever its size, so the gap widens as the tables grow.
+
+ The mean time per lookup is printed to Serial for each size. The tables live
+ on the stack only while their size is measured; the largest case (128 entries)
+ needs about 1.2 KB.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include <RTL_FixedMap.h>
+
+
+#define LOOKUPS     20000UL
+
+
+struct Pair
+{
+    uint16_t Key;
+    uint8_t Value;
+};
+
+
+volatile uint8_t sink;
+
+
+// Scattered IDs, like node or sensor addresses
+uint16_t KeyOf(uint16_t i) { return uint16_t(i * 40503U + 12345U); }
+
+
+uint8_t* Find(Pair* pairs, size_t count, uint16_t key)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pairs[i].Key == key) return &pairs[i].Value;
+    }
+
+    return NULL;
+}
+
+
+template <size_t N> void Measure()
+{
+    FixedMap<uint16_t, uint8_t, N, DefaultHash<uint16_t>, NoLock> map;
+    Pair pairs[N];
+
+    for (uint16_t i = 0; i < N; i++)
+    {
+        map.Set(KeyOf(i), i);
+        pairs[i].Key = KeyOf(i);
+        pairs[i].Value = i;
+    }
+
+    uint32_t start = micros();
+
+    for (uint32_t i = 0; i < LOOKUPS; i++) sink = *map.Find(KeyOf(i % N));
+
+    uint32_t hashed = micros() - start;
+
+    start = micros();
+
+    for (uint32_t i = 0; i < LOOKUPS; i++) sink = *Find(pairs, N, KeyOf(i % N));
+
+    uint32_t scanned = micros() - start;
+
+    Serial.print(F("entries="));
+    Serial.print(N);
+    Serial.print(F(" FixedMap="));
+    Serial.print(hashed * 1000.0 / LOOKUPS);
+    Serial.print(F("ns linear scan="));
+    Serial.print(scanned * 1000.0 / LOOKUPS);
+    Serial.println(F("ns"));
+}
+
+
+void setup()
+{
+    Serial.begin(115200);
+
+    while (!Serial) ;
+
+    Serial.println(F("Mean lookup time, FixedMap against a linear scan"));
+
+    Measure<8>();
+    Measure<32>();
+    Measure<64>();
+    Measure<128>();
+}
+
+
+void loop()
+{
+}
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ PriorityQueueLatency
+
+ Measures the worst-case dispatch delay of urgent events under load, with a
+ plain FIFO Queue and with a PriorityQueue.
+
+ Two kinds of event are produced:
+
+  - an urgent event every URGENT_PERIOD µs, stamped with the time it was
+    due;
+
+  - a burst of BURST_SIZE background events every BURST_PERIOD µs, each of
+    which takes BACKGROUND_WORK µs to handle.
+
+ loop() dispatches one event at a time. The dispatch delay of an urgent event
+ is the time from when it was due to when its handler starts. With the FIFO
+ queue an urgent event waits behind every background event queued before it.
+ With the PriorityQueue it waits for at most the one background event that is
+ being handled when it arrives.
+
+ The results (worst and mean delay, and the number of events that could not be
+ queued) are printed to Serial after each test has run for TEST_DURATION ms.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include <RTL_Queue.h>
+#include <RTL_PriorityQueue.h>
+
+
+#define URGENT_PERIOD       1000UL      // µs
+#define BURST_PERIOD        2000UL      // µs
+#define BURST_SIZE          8
+#define BACKGROUND_WORK     200         // µs (so the background load is 80%)
+#define TEST_DURATION       5000UL      // ms
+#define QUEUE_SIZE          32
+
+
+struct Event
+{
+    uint32_t Stamp;
+    bool Urgent;
+};
+
+
+struct Results
+{
+    uint32_t Worst;
+    uint32_t Total;
+    uint32_t Count;
+    uint32_t Dropped;
+};
+
+
+Queue<Event, QUEUE_SIZE> fifo;
+PriorityQueue<Event, QUEUE_SIZE, 2> prioritized;
+
+
+bool Enqueue(Queue<Event, QUEUE_SIZE>& queue, const Event& event) { return queue.Add(event); }
+
+bool Enqueue(PriorityQueue<Event, QUEUE_SIZE, 2>& queue, const Event& event) { return queue.Add(event, event.Urgent ? 0 : 1); }
+
+
+//******************************************************************************
+/// Produces and dispatches events through one queue for TEST_DURATION ms.
+//******************************************************************************
+template <typename Q> Results Run(Q& queue)
+{
+    Results results = { 0, 0, 0, 0 };
+    uint32_t start = millis();
+    uint32_t nextUrgent = micros();
+    uint32_t nextBurst = nextUrgent;
+    Event event;
+
+    while (millis() - start < TEST_DURATION)
+    {
+        uint32_t now = micros();
+
+        if (int32_t(now - nextBurst) >= 0)
+        {
+            event.Stamp = now;
+            event.Urgent = false;
+
+            for (uint8_t i = 0; i < BURST_SIZE; i++)
+            {
+                if (!Enqueue(queue, event)) results.Dropped++;
+            }
+
+            nextBurst += BURST_PERIOD;
+        }
+
+        // Events are produced between dispatches, as if by a timer ISR that
+        // fired at the scheduled time; stamping them with that time counts the
+        // handling in progress when they "arrived" as part of their delay.
+        if (int32_t(now - nextUrgent) >= 0)
+        {
+            event.Stamp = nextUrgent;
+            event.Urgent = true;
+
+            if (!Enqueue(queue, event)) results.Dropped++;
+
+            nextUrgent += URGENT_PERIOD;
+        }
+
+        if (queue.Remove(event))
+        {
+            if (event.Urgent)
+            {
+                uint32_t delay = micros() - event.Stamp;
+
+                if (delay > results.Worst) results.Worst = delay;
+
+                results.Total += delay;
+                results.Count++;
+            }
+            else
+                delayMicroseconds(BACKGROUND_WORK);
+        }
+    }
+
+    // Drain the queue for the next test
+    while (queue.Remove(event)) ;
+
+    return results;
+}
+
+
+void Report(const __FlashStringHelper* name, const Results& results)
+{
+    Serial.print(name);
+    Serial.print(F(": urgent events="));
+    Serial.print(results.Count);
+    Serial.print(F(" worst delay="));
+    Serial.print(results.Worst);
+    Serial.print(F("us mean delay="));
+    Serial.print((results.Count > 0) ? results.Total / results.Count : 0);
+    Serial.print(F("us dropped="));
+    Serial.println(results.Dropped);
+}
+
+
+void setup()
+{
+    Serial.begin(115200);
+
+    while (!Serial) ;
+
+    Serial.println(F("Dispatch delay of urgent events under load"));
+}
+
+
+void loop()
+{
+    Report(F("Queue        "), Run(fifo));
+    Report(F("PriorityQueue"), Run(prioritized));
+
+    Serial.println();
+}
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ A minimal stand-in for the Arduino core, so that the library can be compiled
+ and its host tests (the test_*.cpp files in this directory) run on a PC. It
+ provides only what the library uses. millis() and micros() return values that
+ the tests set (see SetMillis()), so timing code runs deterministically.
+*******************************************************************************/
+#ifndef _Host_Arduino_h_
+#define _Host_Arduino_h_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+class __FlashStringHelper;
+
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+
+inline unsigned long& HostMillis() { static unsigned long ms = 0; return ms; }
+
+inline unsigned long& HostMicros() { static unsigned long us = 0; return us; }
+
+inline void SetMillis(unsigned long ms) { HostMillis() = ms; HostMicros() = ms * 1000UL; }
+
+inline unsigned long millis() { return HostMillis(); }
+
+inline unsigned long micros() { return HostMicros(); }
+
+inline void noInterrupts() { }
+
+inline void interrupts() { }
+
+
+class Print
+{
+    public: virtual ~Print() { };
+
+    public: virtual size_t write(uint8_t c) = 0;
+
+    public: virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+        size_t n = 0;
+
+        while (size-- > 0) n += write(*buffer++);
+
+        return n;
+    }
+
+    public: size_t print(const char* s) { return write(reinterpret_cast<const uint8_t*>(s), strlen(s)); };
+
+    public: size_t print(const __FlashStringHelper* s) { return print(reinterpret_cast<const char*>(s)); };
+
+    public: size_t print(char c) { return write(uint8_t(c)); };
+
+    public: size_t print(int value, int base=10) { return print(long(value), base); };
+
+    public: size_t print(unsigned int value, int base=10) { return print((unsigned long)value, base); };
+
+    public: size_t print(long value, int base=10)
+    {
+        if (value >= 0 || base != 10) return print((unsigned long)value, base);
+
+        return print('-') + print((unsigned long)(-value), base);
+    }
+
+    public: size_t print(unsigned long value, int base=10)
+    {
+        char text[8 * sizeof(long) + 1];
+        char* p = &text[sizeof(text) - 1];
+
+        *p = '\0';
+
+        do
+        {
+            unsigned digit = unsigned(value % base);
+
+            *--p = char((digit < 10) ? '0' + digit : 'A' + digit - 10);
+            value /= base;
+        }
+        while (value != 0);
+
+        return print(p);
+    }
+
+    public: size_t print(double value, int digits=2)
+    {
+        char text[64];
+
+        snprintf(text, sizeof(text), "%.*f", digits, value);
+
+        return print(text);
+    }
+
+    public: size_t println() { return print("\r\n"); };
+};
+
+
+class Stream : public Print
+{
+    public: virtual int available() = 0;
+
+    public: virtual int read() = 0;
+
+    public: virtual int peek() = 0;
+
+    public: size_t readBytes(uint8_t* buffer, size_t length)
+    {
+        size_t count = 0;
+
+        for (int c; count < length && (c = read()) >= 0; ) buffer[count++] = uint8_t(c);
+
+        return count;
+    }
+};
+
+
+template <typename T> inline Print& operator<<(Print& out, T value) { out.print(value); return out; }
+
+#endif
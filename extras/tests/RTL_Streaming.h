@@ -0,0 +1,22 @@
+/*******************************************************************************
+ Host stand-in for the RTL_Streaming library (see Arduino.h), providing only the
+ parts that RTL_Debug.h refers to.
+*******************************************************************************/
+#ifndef _Host_RTL_Streaming_h_
+#define _Host_RTL_Streaming_h_
+
+#include "Arduino.h"
+
+
+struct _NullPrint_ : public Print
+{
+    virtual size_t write(uint8_t) { return 1; };
+};
+
+static _NullPrint_ NullPrint;
+
+extern Print& ConsoleStream;
+
+inline unsigned long _HEX(unsigned long value) { return value; }
+
+#endif
@@ -0,0 +1,36 @@
+/*******************************************************************************
+ A minimal check harness for the host tests in this directory.
+
+ Each test_*.cpp file is a stand-alone program that tests one module and exits
+ with status 0 if all of its checks pass. They need no Arduino board: the
+ Arduino.h, pins_arduino.h and RTL_Streaming.h in this directory stand in for
+ the Arduino core. Build and run a test from this directory with any C++11
+ compiler, adding the module's .cpp file where it has one, e.g.:
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_pool test_pool.cpp && ./test_pool
+
+ (-fpermissive is needed for RTL_Stdlib.h's PTR() macro, which casts pointers
+ to 32 bits.) The exact command for each test is at the top of its file.
+*******************************************************************************/
+#ifndef _Test_h_
+#define _Test_h_
+
+#include <stdio.h>
+
+
+inline int& TestFailures() { static int failures = 0; return failures; }
+
+
+#define CHECK(condition) \
+    do { if (!(condition)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); TestFailures()++; } } while (0)
+
+
+// Reports the result; return it from main()
+inline int TestResult(const char* name)
+{
+    printf("%s: %s\n", name, (TestFailures() == 0) ? "passed" : "FAILED");
+
+    return (TestFailures() == 0) ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,5 @@
+/*******************************************************************************
+ Host stand-in for the Arduino core's pins_arduino.h (see Arduino.h). The host
+ has no pins to describe.
+*******************************************************************************/
+#include "Arduino.h"
@@ -0,0 +1,145 @@
+/*******************************************************************************
+ Host test for Debouncer (RTL_Debounce.h): the vertical counters debounce each
+ input exactly like a separate per-input counter would, and each edge is
+ reported once.
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_debounce test_debounce.cpp && ./test_debounce
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Debounce.h"
+#include "Test.h"
+
+
+static void TestOneInput()
+{
+    Debouncer<1, uint8_t, NoLock> debouncer;
+    uint8_t on = 1, off = 0;
+
+    // 3 samples are not enough to register a change
+    for (int i = 0; i < 3; i++) debouncer.Update(&on);
+
+    CHECK(!debouncer.IsActive(0) && debouncer.TakePressed(0) == 0);
+
+    // A sample that agrees with the debounced state starts the count again
+    debouncer.Update(&off);
+
+    for (int i = 0; i < 3; i++) debouncer.Update(&on);
+
+    CHECK(!debouncer.IsActive(0));
+
+    // The 4th consecutive sample does, and the edge is reported once
+    debouncer.Update(&on);
+
+    CHECK(debouncer.IsActive(0));
+    CHECK(debouncer.TakePressed(0) == 1);
+    CHECK(debouncer.TakePressed(0) == 0);
+    CHECK(debouncer.TakeReleased(0) == 0);
+
+    // Holding the input keeps it active with no further edges
+    for (int i = 0; i < 10; i++) debouncer.Update(&on);
+
+    CHECK(debouncer.IsActive(0) && debouncer.TakeChanged(0) == 0);
+
+    for (int i = 0; i < 4; i++) debouncer.Update(&off);
+
+    CHECK(!debouncer.IsActive(0));
+    CHECK(debouncer.TakeReleased(0) == 1);
+
+    // Starting from the current inputs reports no edges
+    debouncer.Reset(&on);
+
+    for (int i = 0; i < 10; i++) debouncer.Update(&on);
+
+    CHECK(debouncer.IsActive(0) && debouncer.TakeChanged(0) == 0);
+}
+
+
+static uint32_t _random = 99;
+
+static uint32_t Random()
+{
+    _random = _random * 1103515245UL + 12345UL;
+
+    return _random >> 8;
+}
+
+
+// Debounces bouncing inputs and compares the result, sample by sample, with a
+// separate counter per input
+template <typename Word> static void TestAgainstModel()
+{
+    const size_t Inputs = 40;
+    typedef Debouncer<Inputs, Word, NoLock> Keys;
+
+    Keys keys;
+    bool raw[Inputs] = { };
+    bool state[Inputs] = { };
+    uint8_t count[Inputs] = { };
+    bool pressed[Inputs] = { };         // Edges since they were last taken
+    bool released[Inputs] = { };
+    int edges = 0;
+
+    for (int step = 0; step < 20000; step++)
+    {
+        Word samples[Keys::Words] = { };
+
+        for (size_t n = 0; n < Inputs; n++)
+        {
+            // Each input is held for a while, bouncing now and then
+            if (Random() % 16 == 0) raw[n] = !raw[n];
+
+            bool sample = (Random() % 8 == 0) ? !raw[n] : raw[n];
+
+            if (sample) samples[n / Keys::WordBits] |= Word(Word(1) << (n % Keys::WordBits));
+
+            if (sample == state[n])
+            {
+                count[n] = 0;
+            }
+            else if (++count[n] == 4)
+            {
+                count[n] = 0;
+                state[n] = sample;
+                (sample ? pressed[n] : released[n]) = true;
+                edges++;
+            }
+        }
+
+        keys.Update(samples);
+
+        for (size_t n = 0; n < Inputs; n++) CHECK(keys.IsActive(n) == state[n]);
+
+        // Take the edges now and then, so that edges of several inputs (and
+        // both edges of an input) can accumulate in between
+        if (step % 7 == 0)
+        {
+            Word p[Keys::Words], r[Keys::Words];
+
+            keys.TakeEdges(p, r);
+
+            for (size_t n = 0; n < Inputs; n++)
+            {
+                Word bit = Word(Word(1) << (n % Keys::WordBits));
+
+                CHECK(((p[n / Keys::WordBits] & bit) != 0) == pressed[n]);
+                CHECK(((r[n / Keys::WordBits] & bit) != 0) == released[n]);
+
+                pressed[n] = released[n] = false;
+            }
+        }
+    }
+
+    // The inputs did change state, many times
+    CHECK(edges > 1000);
+}
+
+
+int main()
+{
+    TestOneInput();
+    TestAgainstModel<uint8_t>();
+    TestAgainstModel<uint32_t>();
+
+    return TestResult("test_debounce");
+}
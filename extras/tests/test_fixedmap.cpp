@@ -0,0 +1,162 @@
+/*******************************************************************************
+ Host test for FixedMap (RTL_FixedMap.h): backward shift deletion keeps every
+ remaining key reachable, including probe runs that wrap around the end of the
+ table, checked against a simple reference model.
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_fixedmap test_fixedmap.cpp && ./test_fixedmap
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_FixedMap.h"
+#include "Test.h"
+
+
+// Places each key at a chosen home slot, so the tests can build collisions:
+// the home slot of key is its high byte (the map takes it from the top bits)
+struct HomeHash
+{
+    inline uint32_t operator()(const uint16_t& key) const { return uint32_t(key >> 8) << 28; };
+};
+
+
+static inline uint16_t Key(uint8_t home, uint8_t id) { return uint16_t((home << 8) | id); }
+
+
+// Counts live values, to check that each is destroyed exactly once
+struct Value
+{
+    Value(int n=0) : N(n) { Live++; };
+
+    Value(const Value& other) : N(other.N) { Live++; };
+
+    ~Value() { Live--; };
+
+    Value& operator=(const Value& other) { N = other.N; return *this; };
+
+    int N;
+
+    static int Live;
+};
+
+int Value::Live = 0;
+
+
+typedef FixedMap<uint16_t, Value, 12, HomeHash, NoLock> Map;
+
+
+// The value for a key, or -1 if it is not in the map
+static int Lookup(Map& map, uint16_t key)
+{
+    Value* value = map.Find(key);
+
+    return (value != NULL) ? value->N : -1;
+}
+
+
+static void TestWrappedRun()
+{
+    static_assert(Map::Slots == 16, "The test assumes a 16 slot table");
+
+    Map map;
+
+    // Homes 14, 14, 15, 15 and 0 fill slots 14, 15, 0, 1 and 2
+    const uint16_t keys[] = { Key(14, 1), Key(14, 2), Key(15, 3), Key(15, 4), Key(0, 5) };
+
+    for (int i = 0; i < 5; i++) CHECK(map.Set(keys[i], Value(i)));
+
+    // Removing the head of the run shifts the rest back across the wrap
+    CHECK(map.Remove(keys[0]));
+    CHECK(!map.Contains(keys[0]));
+
+    for (int i = 1; i < 5; i++) CHECK(Lookup(map, keys[i]) == i);
+
+    // A key homed at 0 may not move back before slot 0, even into an empty slot
+    CHECK(map.Remove(keys[2]));
+    CHECK(map.Remove(keys[3]));
+    CHECK(Lookup(map, keys[4]) == 4);
+    CHECK(Lookup(map, keys[1]) == 1);
+    CHECK(map.Count() == 2);
+
+    // Adding after removals reuses the freed slots, and nothing is lost
+    CHECK(map.Set(Key(15, 6), Value(6)));
+    CHECK(map.Set(Key(14, 7), Value(7)));
+    CHECK(Lookup(map, Key(15, 6)) == 6 && Lookup(map, Key(14, 7)) == 7 && Lookup(map, keys[4]) == 4);
+
+    map.Clear();
+
+    CHECK(map.IsEmpty());
+}
+
+
+static uint32_t _random = 12345;
+
+static uint32_t Random(uint32_t n)
+{
+    _random = _random * 1103515245UL + 12345UL;
+
+    return (_random >> 8) % n;
+}
+
+
+static void TestAgainstModel()
+{
+    // Keys from 6 homes with 6 IDs each, so most keys collide with others
+    const int Keys = 36;
+    bool present[Keys] = { };
+    int values[Keys] = { };
+    int count = 0;
+
+    {
+        Map map;
+
+        for (int step = 0; step < 20000; step++)
+        {
+            int k = int(Random(Keys));
+            uint16_t key = Key(uint8_t((k / 6) * 3), uint8_t(k % 6));
+
+            if (Random(2) == 0)
+            {
+                bool added = map.Set(key, Value(step));
+
+                if (present[k] || count < 12)
+                {
+                    CHECK(added);
+
+                    if (!present[k]) count++;
+
+                    present[k] = true;
+                    values[k] = step;
+                }
+                else
+                {
+                    CHECK(!added);
+                }
+            }
+            else
+            {
+                CHECK(map.Remove(key) == present[k]);
+
+                if (present[k]) count--;
+
+                present[k] = false;
+            }
+
+            // Every key is found (with its latest value) exactly when it should be
+            for (int j = 0; j < Keys; j++) CHECK(Lookup(map, Key(uint8_t((j / 6) * 3), uint8_t(j % 6))) == (present[j] ? values[j] : -1));
+
+            CHECK(map.Count() == count);
+            CHECK(Value::Live == count);
+        }
+    }
+
+    CHECK(Value::Live == 0);
+}
+
+
+int main()
+{
+    TestWrappedRun();
+    TestAgainstModel();
+
+    return TestResult("test_fixedmap");
+}
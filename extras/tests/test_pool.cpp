@@ -0,0 +1,127 @@
+/*******************************************************************************
+ Host test for Pool (RTL_Pool.h): allocation until exhaustion, and rejection of
+ double frees and of pointers that do not belong to the pool.
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_pool test_pool.cpp && ./test_pool
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Pool.h"
+#include "Test.h"
+
+
+// Counts live objects, to check that destructors run exactly once
+struct Tracked
+{
+    Tracked(int value) : Value(value) { Live++; };
+
+    ~Tracked() { Live--; };
+
+    int Value;
+
+    static int Live;
+};
+
+int Tracked::Live = 0;
+
+
+static void TestExhaustion()
+{
+    Pool<Tracked, 4, NoLock> pool;
+    Tracked* objects[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        objects[i] = pool.Create(i);
+        CHECK(objects[i] != NULL && objects[i]->Value == i);
+    }
+
+    CHECK(pool.IsFull() && pool.Used() == 4 && pool.Peak() == 4);
+    CHECK(pool.Create(4) == NULL);
+    CHECK(pool.Failures() == 1);
+    CHECK(Tracked::Live == 4);
+
+    // Handles and pointers convert both ways
+    for (int i = 0; i < 4; i++) CHECK(pool.Get(pool.HandleOf(objects[i])) == objects[i]);
+
+    CHECK(pool.Destroy(objects[2]));
+    CHECK(pool.Available() == 1);
+
+    // The freed slot is reused
+    CHECK(pool.Create(5) == objects[2]);
+
+    for (int i = 0; i < 4; i++) CHECK(pool.Destroy(objects[i]));
+
+    CHECK(pool.IsEmpty() && Tracked::Live == 0);
+}
+
+
+static void TestDoubleFree()
+{
+    Pool<Tracked, 4, NoLock> pool;
+
+    Tracked* a = pool.Create(1);
+    Tracked* b = pool.Create(2);
+
+    CHECK(pool.Destroy(a));
+    CHECK(Tracked::Live == 1);
+
+    // A second Destroy() or Free() of the same object fails and destroys nothing
+    CHECK(!pool.Destroy(a));
+    CHECK(!pool.Free(a));
+    CHECK(!pool.Destroy(pool.HandleOf(a)));
+    CHECK(Tracked::Live == 1 && pool.Used() == 1);
+
+    // The free-list was not corrupted: the pool still holds exactly 3 more
+    Tracked* c = pool.Create(3);
+    Tracked* d = pool.Create(4);
+    Tracked* e = pool.Create(5);
+
+    CHECK(c != NULL && d != NULL && e != NULL);
+    CHECK(c != d && d != e && c != e && c != b && d != b && e != b);
+    CHECK(pool.Create(6) == NULL);
+
+    // Raw allocations are checked the same way
+    CHECK(pool.Destroy(c));
+
+    void* raw = pool.Allocate();
+
+    CHECK(raw != NULL);
+    CHECK(pool.Free(raw));
+    CHECK(!pool.Free(raw));
+
+    pool.Destroy(b);
+    pool.Destroy(d);
+    pool.Destroy(e);
+
+    CHECK(pool.IsEmpty() && Tracked::Live == 0);
+}
+
+
+static void TestForeignPointers()
+{
+    Pool<Tracked, 4, NoLock> pool;
+    Tracked other(0);
+
+    Tracked* a = pool.Create(1);
+    uint8_t* inside = reinterpret_cast<uint8_t*>(a) + 1;
+
+    CHECK(pool.HandleOf(&other) == pool.NullHandle);
+    CHECK(!pool.Destroy(&other));
+    CHECK(!pool.Free(inside));
+    CHECK(pool.Get(4) == NULL);
+    CHECK(!pool.Destroy(pool.NullHandle));
+    CHECK(pool.Used() == 1);
+
+    pool.Destroy(a);
+}
+
+
+int main()
+{
+    TestExhaustion();
+    TestDoubleFree();
+    TestForeignPointers();
+
+    return TestResult("test_pool");
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+ Host test for SortedList (RTL_SortedList.h): InsertRange() merges a batch into
+ the list in order, keeping equal items in the order they were added, and adds
+ nothing when the batch does not fit.
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_sortedlist test_sortedlist.cpp && ./test_sortedlist
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_SortedList.h"
+#include "Test.h"
+
+
+// Ordered by Key only, so items with equal keys are told apart by their Tag.
+// It is not trivially copyable, so the merge constructs and assigns items
+// rather than moving bytes, and the live count shows that none are leaked.
+struct Item
+{
+    Item(int key=0, int tag=0) : Key(key), Tag(tag) { Live++; };
+
+    Item(const Item& other) : Key(other.Key), Tag(other.Tag) { Live++; };
+
+    ~Item() { Live--; };
+
+    Item& operator=(const Item& other) { Key = other.Key; Tag = other.Tag; return *this; };
+
+    bool operator<(const Item& other) const { return Key < other.Key; };
+
+    int Key;
+    int Tag;
+
+    static int Live;
+};
+
+int Item::Live = 0;
+
+
+static uint32_t _random = 2024;
+
+static int Random(int n)
+{
+    _random = _random * 1103515245UL + 12345UL;
+
+    return int((_random >> 8) % uint32_t(n));
+}
+
+
+// Merges a batch of the given size into a list of the given size. Tags are
+// handed out in the order items are added, list items first, so the result
+// must be ordered by key and then by tag, with every tag present once.
+static void TestMerge(int listSize, int batchSize, int keys)
+{
+    SortedList<Item, 64, Less<Item>, NoLock> list;
+    Item batch[64];
+    int tag = 0;
+
+    for (int i = 0; i < listSize; i++) CHECK(list.Add(Item(Random(keys), tag++)));
+
+    for (int i = 0; i < batchSize; i++) batch[i] = Item(Random(keys), tag++);
+
+    CHECK(list.InsertRange(batch, batchSize));
+    CHECK(list.Count() == listSize + batchSize);
+
+    bool seen[128] = { };
+
+    for (int i = 0; i < list.Count(); i++)
+    {
+        CHECK(!seen[list[i].Tag]);
+        seen[list[i].Tag] = true;
+
+        if (i > 0)
+        {
+            const Item& a = list[i - 1];
+            const Item& b = list[i];
+
+            CHECK(a.Key < b.Key || (a.Key == b.Key && a.Tag < b.Tag));
+        }
+    }
+}
+
+
+static void TestNoRoom()
+{
+    SortedList<Item, 8, Less<Item>, NoLock> list;
+    Item batch[5] = { Item(5, 0), Item(1, 1), Item(3, 2), Item(2, 3), Item(4, 4) };
+
+    for (int i = 0; i < 4; i++) list.Add(Item(i * 2, 10 + i));
+
+    // 4 + 5 items do not fit in 8, so none are added
+    CHECK(!list.InsertRange(batch, 5));
+    CHECK(list.Count() == 4);
+
+    for (int i = 0; i < 4; i++) CHECK(list[i].Key == i * 2 && list[i].Tag == 10 + i);
+
+    CHECK(list.InsertRange(batch, 4));
+    CHECK(list.Count() == 8 && list.IsFull());
+
+    for (int i = 1; i < 8; i++) CHECK(!(list[i] < list[i - 1]));
+}
+
+
+int main()
+{
+    // Batches both shorter and longer than the 16 items up to which Sort() is
+    // stable, and few keys (every other run) make many equal items
+    const int sizes[][2] = { { 0, 5 }, { 5, 0 }, { 10, 10 }, { 1, 40 }, { 30, 30 }, { 40, 24 }, { 0, 64 } };
+
+    for (int k = 0; k < 100; k++)
+    {
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) TestMerge(sizes[i][0], sizes[i][1], (k % 2) ? 4 : 1000);
+    }
+
+    TestNoRoom();
+
+    CHECK(Item::Live == 0);
+
+    return TestResult("test_sortedlist");
+}
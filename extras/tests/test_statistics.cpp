@@ -0,0 +1,246 @@
+/*******************************************************************************
+ Host test for the streaming statistics (RTL_Statistics.h): Welford mean and
+ variance (RunningStats) and exact integer sums (IntegerStats) against two-pass
+ results, P² quantile estimates against exact quantiles, and histogram bins
+ against direct division.
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_statistics test_statistics.cpp && ./test_statistics
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Statistics.h"
+#include "Test.h"
+
+
+static uint32_t _random = 7;
+
+// Uniform in [0, 1)
+static double Random()
+{
+    _random = _random * 1103515245UL + 12345UL;
+
+    return double((_random >> 8) & 0xFFFFFF) / double(0x1000000);
+}
+
+
+static bool Near(double a, double b, double tolerance) { return fabs(a - b) <= tolerance; }
+
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    double x = *static_cast<const double*>(a), y = *static_cast<const double*>(b);
+
+    return (x < y) ? -1 : (y < x) ? 1 : 0;
+}
+
+
+static void TestWelford()
+{
+    const int Count = 10000;
+    static double samples[Count];
+    double sum = 0;
+
+    // A large offset with a small spread, which the sum of squares method
+    // loses in float precision
+    for (int i = 0; i < Count; i++) sum += (samples[i] = 10000.0 + Random());
+
+    double mean = sum / Count, m2 = 0;
+
+    for (int i = 0; i < Count; i++) m2 += (samples[i] - mean) * (samples[i] - mean);
+
+    RunningStats<float> single;
+    RunningStats<double> whole, parts[4];
+
+    for (int i = 0; i < Count; i++)
+    {
+        single.Update(float(samples[i]));
+        whole.Update(samples[i]);
+        parts[i % 4].Update(samples[i]);
+    }
+
+    CHECK(whole.Count() == Count);
+    CHECK(Near(whole.Mean(), mean, 1e-9));
+    CHECK(Near(whole.Variance(), m2 / Count, 1e-9));
+    CHECK(Near(whole.SampleVariance(), m2 / (Count - 1), 1e-9));
+
+    // The variance of a uniform [0, 1) distribution is 1/12, and float Welford
+    // keeps it to within a few percent despite the offset
+    CHECK(Near(single.Mean(), mean, 0.01));
+    CHECK(Near(single.Variance(), m2 / Count, 0.005));
+
+    // Merging the parts gives the same result as the whole
+    for (int i = 1; i < 4; i++) parts[0].Merge(parts[i]);
+
+    CHECK(parts[0].Count() == Count);
+    CHECK(Near(parts[0].Mean(), mean, 1e-9));
+    CHECK(Near(parts[0].Variance(), m2 / Count, 1e-9));
+
+    // Degenerate cases
+    RunningStats<double> none, one;
+
+    one.Update(5);
+
+    CHECK(none.Mean() == 0 && none.Variance() == 0 && none.SampleVariance() == 0);
+    CHECK(one.Mean() == 5 && one.Variance() == 0 && one.SampleVariance() == 0);
+
+    none.Merge(one);
+
+    CHECK(none.Count() == 1 && none.Mean() == 5);
+}
+
+
+static void TestIntegerStats()
+{
+    IntegerStats<int16_t> whole, a, b;
+    int64_t sum = 0, sumSquares = 0;
+
+    for (int i = 0; i < 5000; i++)
+    {
+        int16_t x = int16_t(Random() * 65535.0 - 32768.0);
+
+        sum += x;
+        sumSquares += int64_t(x) * x;
+        whole.Update(x);
+        ((i < 1234) ? a : b).Update(x);
+    }
+
+    CHECK(whole.Sum() == sum && whole.SumSquares() == sumSquares);
+
+    a.Merge(b);
+
+    CHECK(a.Count() == 5000 && a.Sum() == sum && a.SumSquares() == sumSquares);
+
+    double mean = double(sum) / 5000, variance = double(sumSquares) / 5000 - mean * mean;
+
+    CHECK(Near(whole.Mean(), mean, 0.01));
+    CHECK(Near(whole.Variance(), variance, variance * 1e-5));
+
+    // A constant signal has exactly zero variance, however large it is
+    IntegerStats<int16_t> constant;
+
+    for (int i = 0; i < 1000; i++) constant.Update(32000);
+
+    CHECK(constant.Variance() == 0.0f && constant.IntegerMean() == 32000);
+}
+
+
+// Estimates quantile p of count samples from a distribution with P², and
+// checks it against the exact quantile within the given tolerance
+template <typename Distribution> static void TestP2(double p, int count, Distribution next, double tolerance)
+{
+    static double samples[20000];
+    P2Quantile<double> estimate(p);
+
+    for (int i = 0; i < count; i++) estimate.Update(samples[i] = next());
+
+    qsort(samples, size_t(count), sizeof(double), CompareDoubles);
+
+    CHECK(estimate.Count() == uint32_t(count));
+    CHECK(Near(estimate.Value(), samples[int(p * (count - 1) + 0.5)], tolerance));
+}
+
+
+static double Uniform() { return Random(); }
+
+static double Bell() { double x = 0; for (int i = 0; i < 12; i++) x += Random(); return x - 6; }
+
+static double Skewed() { return -log(1 - Random()); }
+
+static int _next = 0;
+
+static double Ascending() { return _next++; }
+
+
+static void TestP2Quantiles()
+{
+    const double ps[] = { 0.05, 0.5, 0.9, 0.99 };
+
+    for (int i = 0; i < 4; i++)
+    {
+        TestP2(ps[i], 20000, Uniform, 0.01);
+        TestP2(ps[i], 20000, Bell, 0.05);
+        TestP2(ps[i], 20000, Skewed, 0.1 * (1 - log(1 - ps[i])));
+    }
+
+    _next = 0;
+    TestP2(0.5, 10001, Ascending, 10);
+
+    // Until there are 5 samples the quantile is exact
+    P2Quantile<float> median(0.5f);
+
+    CHECK(median.Value() == 0);
+
+    median.Update(3);
+    median.Update(1);
+    median.Update(2);
+
+    CHECK(median.Value() == 2);
+
+    median.Update(10);
+    median.Update(0);
+
+    CHECK(median.Value() == 2);
+}
+
+
+// Checks the bin of every sample in the range against a direct division
+template <typename T> static void TestHistogramBins(T low, T high, int64_t step)
+{
+    const uint16_t Bins = 7;
+    Histogram<T, Bins> histogram(low, high);
+    uint32_t expected[Bins] = { };
+    int64_t range = int64_t(high) - int64_t(low);
+
+    for (int64_t x = int64_t(low); x < int64_t(high); x += step)
+    {
+        histogram.Update(T(x));
+        expected[(x - int64_t(low)) * Bins / range]++;
+    }
+
+    // The last sample before each bin edge and the first one at it
+    for (uint16_t i = 1; i < Bins; i++)
+    {
+        int64_t edge = int64_t(low) + (range * i + Bins - 1) / Bins;
+
+        histogram.Update(T(edge - 1));
+        histogram.Update(T(edge));
+        expected[i - 1]++;
+        expected[i]++;
+    }
+
+    for (uint16_t i = 0; i < Bins; i++) CHECK(histogram.Bin(i) == expected[i]);
+
+    // low is above the smallest T, so that there is a sample below the range
+    histogram.Update(T(int64_t(low) - 1));
+    histogram.Update(high);
+
+    CHECK(histogram.Below() == 1 && histogram.Above() == 1);
+}
+
+
+static void TestHistogram()
+{
+    TestHistogramBins<int16_t>(-32767, 32767, 1);
+    TestHistogramBins<uint16_t>(100, 60000, 1);
+    TestHistogramBins<int32_t>(-2000000000, 2000000000, 9973);
+    TestHistogramBins<uint32_t>(1000, 4294967295UL, 65521);
+
+    // The quantile of evenly spread samples falls within a bin of the exact one
+    Histogram<float, 100> histogram(0, 1);
+
+    for (int i = 0; i < 10000; i++) histogram.Update(float(Random()));
+
+    CHECK(Near(histogram.Quantile(0.5f), 0.5, 0.02));
+    CHECK(Near(histogram.Quantile(0.9f), 0.9, 0.02));
+}
+
+
+int main()
+{
+    TestWelford();
+    TestIntegerStats();
+    TestP2Quantiles();
+    TestHistogram();
+
+    return TestResult("test_statistics");
+}
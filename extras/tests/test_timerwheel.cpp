@@ -0,0 +1,173 @@
+/*******************************************************************************
+ Host test for TimerWheel (RTL_TimerWheel.h): timers of every delay fire on the
+ right tick as they cascade down the levels of the wheel, including delays
+ beyond its range, periodic timers and cancellation, across millis() wrapping.
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_timerwheel test_timerwheel.cpp ../../RTL_TimerWheel.cpp && ./test_timerwheel
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_TimerWheel.h"
+#include "Test.h"
+
+
+// Records the millis() value (relative to Start) of each expiry of one timer
+struct Expiries
+{
+    Expiries() : Count(0) { };
+
+    uint32_t Times[4];
+    uint8_t Count;
+
+    static uint32_t Start;
+};
+
+uint32_t Expiries::Start = 0;
+
+
+static void Expired(void* arg)
+{
+    Expiries* expiries = static_cast<Expiries*>(arg);
+
+    if (expiries->Count < 4) expiries->Times[expiries->Count] = uint32_t(millis()) - Expiries::Start;
+
+    expiries->Count++;
+}
+
+
+// Advances millis() one millisecond at a time, updating the wheel each time
+static void Run(TimerWheel& wheel, uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++)
+    {
+        SetMillis(millis() + 1);
+        wheel.Update();
+    }
+}
+
+
+static void TestCascade(uint32_t start)
+{
+    // The delays at and either side of each level boundary (16, 256, 4096 and
+    // 65536 ticks), and beyond the range of the wheel
+    static const uint32_t Delays[] =
+    {
+        0, 1, 15, 16, 17, 255, 256, 257, 4095, 4096, 4097, 65535, 65536, 65537, 100000, 200003
+    };
+    const size_t Count = sizeof(Delays) / sizeof(Delays[0]);
+
+    SetMillis(start);
+    Expiries::Start = start;
+
+    TimerWheel wheel;
+    Timer timers[Count];
+    Expiries expiries[Count];
+
+    for (size_t i = 0; i < Count; i++)
+    {
+        timers[i].SetCallback(Expired, &expiries[i]);
+        wheel.Schedule(timers[i], Delays[i]);
+    }
+
+    Run(wheel, 200010);
+
+    // The current millisecond is already partly over, so each timer fires on the
+    // first Update() once its delay has fully elapsed
+    for (size_t i = 0; i < Count; i++)
+    {
+        CHECK(expiries[i].Count == 1);
+        CHECK(expiries[i].Times[0] == Delays[i] + 1);
+        CHECK(!timers[i].IsActive());
+    }
+}
+
+
+static void TestUnalignedStart()
+{
+    SetMillis(0);
+    Expiries::Start = 0;
+
+    TimerWheel wheel;
+    Timer timer, later;
+    Expiries expiries, laterExpiries;
+
+    timer.SetCallback(Expired, &expiries);
+    later.SetCallback(Expired, &laterExpiries);
+
+    // Scheduled part way through every level, so its slots differ at each level
+    Run(wheel, 4919);
+    wheel.Schedule(timer, 70000);
+    wheel.Schedule(later, 4660);
+
+    Run(wheel, 80000);
+
+    CHECK(expiries.Count == 1 && expiries.Times[0] == 4919 + 70000 + 1);
+    CHECK(laterExpiries.Count == 1 && laterExpiries.Times[0] == 4919 + 4660 + 1);
+}
+
+
+static void TestPeriodic()
+{
+    SetMillis(0);
+    Expiries::Start = 0;
+
+    TimerWheel wheel;
+    Timer timer;
+    Expiries expiries;
+
+    timer.SetCallback(Expired, &expiries);
+    wheel.Schedule(timer, 300, 5000);
+
+    Run(wheel, 10301);
+
+    CHECK(expiries.Count == 3);
+    CHECK(expiries.Times[0] == 301 && expiries.Times[1] == 5301 && expiries.Times[2] == 10301);
+    CHECK(timer.IsActive());
+
+    wheel.Cancel(timer);
+    Run(wheel, 10000);
+
+    CHECK(expiries.Count == 3 && !timer.IsActive());
+}
+
+
+static void TestCancel()
+{
+    SetMillis(0);
+    Expiries::Start = 0;
+
+    TimerWheel wheel;
+    Timer cancelled, rescheduled;
+    Expiries cancelledExpiries, rescheduledExpiries;
+
+    cancelled.SetCallback(Expired, &cancelledExpiries);
+    rescheduled.SetCallback(Expired, &rescheduledExpiries);
+
+    wheel.Schedule(cancelled, 70000);
+    wheel.Schedule(rescheduled, 70000);
+
+    // Both have been cascaded down at least one level by now
+    Run(wheel, 66000);
+
+    CHECK(cancelled.IsActive());
+
+    wheel.Cancel(cancelled);
+    wheel.Schedule(rescheduled, 10);
+
+    Run(wheel, 10000);
+
+    CHECK(cancelledExpiries.Count == 0 && !cancelled.IsActive());
+    CHECK(rescheduledExpiries.Count == 1 && rescheduledExpiries.Times[0] == 66011);
+}
+
+
+int main()
+{
+    TestCascade(0);
+    TestCascade(0xFFFF0000UL);      // millis() wraps part way through
+    TestUnalignedStart();
+    TestPeriodic();
+    TestCancel();
+
+    return TestResult("test_timerwheel");
+}
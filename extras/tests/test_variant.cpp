@@ -0,0 +1,192 @@
+/*******************************************************************************
+ Host test for the variant_t serialization (RTL_Variant.h): every type round
+ trips through a buffer and a stream, and malformed input is rejected.
+
+     g++ -std=gnu++11 -fpermissive -I. -I../.. -o test_variant test_variant.cpp ../../RTL_Variant.cpp && ./test_variant
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Variant.h"
+#include "Test.h"
+
+
+// A Stream over a byte buffer, which records what is written to it
+class BufferStream : public Stream
+{
+    public: BufferStream() : _length(0), _position(0) { };
+
+    public: virtual size_t write(uint8_t c) { if (_length == sizeof(_data)) return 0; _data[_length++] = c; return 1; };
+
+    public: virtual int available() { return int(_length - _position); };
+
+    public: virtual int read() { return (_position < _length) ? _data[_position++] : -1; };
+
+    public: virtual int peek() { return (_position < _length) ? _data[_position] : -1; };
+
+    public: inline size_t Length() const { return _length; };
+
+    private: uint8_t _data[256];
+    private: size_t _length;
+    private: size_t _position;
+};
+
+
+static bool Equal(VariantType type, variant_t a, variant_t b)
+{
+    variant_union_t x = a, y = b;
+
+    switch (type)
+    {
+        case VariantType::Long:         return x.Long == y.Long;
+        case VariantType::UnsignedLong: return x.UnsignedLong == y.UnsignedLong;
+        case VariantType::Int:          return x.Int == y.Int;
+        case VariantType::UnsignedInt:  return x.UnsignedInt == y.UnsignedInt;
+        case VariantType::SByte:        return x.SByte == y.SByte;
+        case VariantType::Byte:         return x.Byte == y.Byte;
+        case VariantType::Char:         return x.Byte == y.Byte;
+        case VariantType::Bool:         return x.Bool == y.Bool;
+        case VariantType::Float:        return x.UnsignedLong == y.UnsignedLong;
+        case VariantType::Pointer:      return x.Pointer == y.Pointer;
+    }
+
+    return false;
+}
+
+
+static const VariantType Types[] =
+{
+    VariantType::Long, VariantType::Long, VariantType::Long, VariantType::Long,
+    VariantType::UnsignedLong, VariantType::UnsignedLong,
+    VariantType::Int, VariantType::Int, VariantType::UnsignedInt,
+    VariantType::SByte, VariantType::SByte, VariantType::Byte, VariantType::Char,
+    VariantType::Bool, VariantType::Bool,
+    VariantType::Float, VariantType::Float,
+    VariantType::Pointer
+};
+
+
+static const variant_t Values[] =
+{
+    variant_t(int32_t(0)), variant_t(int32_t(-1)), variant_t(int32_t(INT32_MIN)), variant_t(int32_t(INT32_MAX)),
+    variant_t(uint32_t(127)), variant_t(uint32_t(UINT32_MAX)),
+    variant_t(int16_t(INT16_MIN)), variant_t(int16_t(300)), variant_t(uint16_t(UINT16_MAX)),
+    variant_t(int8_t(INT8_MIN)), variant_t(int8_t(INT8_MAX)), variant_t(uint8_t(200)), variant_t(uint8_t('x')),
+    variant_t(true), variant_t(false),
+    variant_t(-1.5f), variant_t(3.0e38f),
+    variant_t(reinterpret_cast<void*>(uintptr_t(0x12345678)))
+};
+
+
+static const size_t Count = sizeof(Types) / sizeof(Types[0]);
+
+
+static void TestRoundTrips()
+{
+    for (size_t i = 0; i < Count; i++)
+    {
+        uint8_t buffer[VARIANT_MAX_ENCODED_SIZE];
+        VariantType type;
+        variant_t value;
+
+        size_t length = EncodeVariant(buffer, sizeof(buffer), Types[i], Values[i]);
+
+        CHECK(length > 0);
+        CHECK(DecodeVariant(buffer, length, type, value) == length);
+        CHECK(type == Types[i] && Equal(type, value, Values[i]));
+
+        // Any shorter buffer is too small to encode into, and truncated to decode
+        for (size_t size = 0; size < length; size++)
+        {
+            CHECK(EncodeVariant(buffer, size, Types[i], Values[i]) == 0);
+            CHECK(DecodeVariant(buffer, size, type, value) == 0);
+        }
+
+        BufferStream stream;
+
+        CHECK(EncodeVariant(stream, Types[i], Values[i]) == length);
+        CHECK(DecodeVariant(stream, type, value));
+        CHECK(type == Types[i] && Equal(type, value, Values[i]));
+    }
+}
+
+
+static void TestSmallValues()
+{
+    uint8_t buffer[VARIANT_MAX_ENCODED_SIZE];
+
+    // Small values of either sign fit in a single payload byte
+    CHECK(EncodeVariant(buffer, sizeof(buffer), VariantType::Long, variant_t(int32_t(-64))) == 2);
+    CHECK(EncodeVariant(buffer, sizeof(buffer), VariantType::Long, variant_t(int32_t(63))) == 2);
+    CHECK(EncodeVariant(buffer, sizeof(buffer), VariantType::Long, variant_t(int32_t(64))) == 3);
+    CHECK(EncodeVariant(buffer, sizeof(buffer), VariantType::Bool, variant_t(true)) == 1);
+}
+
+
+static void TestBatches()
+{
+    uint8_t buffer[128];
+    VariantType types[Count];
+    variant_t values[Count];
+    size_t count;
+
+    size_t length = EncodeVariants(buffer, sizeof(buffer), Types, Values, Count);
+
+    CHECK(length > Count);
+    CHECK(DecodeVariants(buffer, length, types, values, Count, count) == length);
+    CHECK(count == Count);
+
+    for (size_t i = 0; i < count; i++) CHECK(types[i] == Types[i] && Equal(types[i], values[i], Values[i]));
+
+    // Too little room for the batch
+    CHECK(DecodeVariants(buffer, length, types, values, Count - 1, count) == 0 && count == 0);
+    CHECK(EncodeVariants(buffer, length - 1, Types, Values, Count) == 0);
+
+    BufferStream stream;
+
+    CHECK(EncodeVariants(stream, Types, Values, Count) == length);
+}
+
+
+static void TestMalformed()
+{
+    VariantType type;
+    variant_t value;
+
+    // A varint can have at most 5 bytes, and the 5th holds only bits 28 to 31
+    const uint8_t largest[] = { 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F };
+    const uint8_t tooLarge[] = { 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F };
+    const uint8_t tooLong[] = { 0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+
+    CHECK(DecodeVariant(largest, sizeof(largest), type, value) == sizeof(largest));
+    CHECK(uint32_t(value) == UINT32_MAX);
+    CHECK(DecodeVariant(tooLarge, sizeof(tooLarge), type, value) == 0);
+    CHECK(DecodeVariant(tooLong, sizeof(tooLong), type, value) == 0);
+
+    // Only a Bool tag may have bits set above the type, and unknown types are rejected
+    const uint8_t boolTrue[] = { 0x17 };
+    const uint8_t strayBit[] = { 0x11, 0x05 };
+    const uint8_t highBit[] = { 0x87 };
+    const uint8_t unknown[] = { 0x0F, 0x05 };
+
+    CHECK(DecodeVariant(boolTrue, sizeof(boolTrue), type, value) == 1 && type == VariantType::Bool && bool(value));
+    CHECK(DecodeVariant(strayBit, sizeof(strayBit), type, value) == 0);
+    CHECK(DecodeVariant(highBit, sizeof(highBit), type, value) == 0);
+    CHECK(DecodeVariant(unknown, sizeof(unknown), type, value) == 0);
+
+    // Pointers are serialized as 32 bits, so one that does not fit is not encoded
+    uint8_t buffer[VARIANT_MAX_ENCODED_SIZE];
+    void* wide = reinterpret_cast<void*>(~uintptr_t(0));
+
+    CHECK(EncodeVariant(buffer, sizeof(buffer), VariantType::Pointer, variant_t(wide)) == ((sizeof(void*) > 4) ? 0 : 6));
+}
+
+
+int main()
+{
+    TestRoundTrips();
+    TestSmallValues();
+    TestBatches();
+    TestMalformed();
+
+    return TestResult("test_variant");
+}
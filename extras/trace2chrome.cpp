@@ -0,0 +1,235 @@
+/*******************************************************************************
+ trace2chrome: converts a trace ring dumped by Trace::Dump() (see RTL_Trace.h)
+ into Chrome trace_event JSON, for viewing in chrome://tracing or Perfetto.
+
+ This is a host program, not part of the Arduino library. Build it with any
+ C++11 compiler:
+
+     g++ -std=c++11 -O2 -o trace2chrome trace2chrome.cpp
+
+ Usage:
+
+     trace2chrome dump.bin [names.txt] > trace.json
+
+ The dump may be a raw capture of the serial port: anything before the "RTLT"
+ magic is skipped. The optional names file maps event IDs to names, one per
+ line, as "<id> <name>"; events without a name are shown as "event <id>".
+
+ Each context becomes a thread in the trace: loop() is "loop" and each
+ interrupt is "ISR <n>", so preemption shows as nesting across tracks.
+ Timestamps are unwrapped (they are 32 bits on the device) and shown in
+ microseconds from the first event.
+*******************************************************************************/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+static uint32_t ReadLE(const unsigned char* p, int bytes)
+{
+    uint32_t value = 0;
+
+    for (int i = bytes - 1; i >= 0; i--) value = (value << 8) | p[i];
+
+    return value;
+}
+
+
+static bool ReadFile(const char* path, std::vector<unsigned char>& data)
+{
+    FILE* file = fopen(path, "rb");
+
+    if (file == NULL) return false;
+
+    unsigned char buffer[4096];
+    size_t n;
+
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + n);
+
+    fclose(file);
+
+    return true;
+}
+
+
+static void ReadNames(const char* path, std::map<unsigned, std::string>& names)
+{
+    FILE* file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "trace2chrome: cannot open %s\n", path);
+        exit(1);
+    }
+
+    char line[256];
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char* end;
+        unsigned long id = strtoul(line, &end, 0);
+
+        if (end == line) continue;
+
+        while (*end == ' ' || *end == '\t') end++;
+
+        std::string name(end);
+
+        while (!name.empty() && (name.back() == '\n' || name.back() == '\r')) name.pop_back();
+
+        names[unsigned(id)] = name;
+    }
+
+    fclose(file);
+}
+
+
+// Writes a string as a JSON string literal
+static void WriteString(const std::string& s)
+{
+    putchar('"');
+
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if ((unsigned char)c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+
+    putchar('"');
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "usage: trace2chrome dump.bin [names.txt] > trace.json\n");
+        return 2;
+    }
+
+    std::vector<unsigned char> data;
+    std::map<unsigned, std::string> names;
+
+    if (!ReadFile(argv[1], data))
+    {
+        fprintf(stderr, "trace2chrome: cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    if (argc == 3) ReadNames(argv[2], names);
+
+    // Find the dump header
+    const size_t HeaderSize = 16;
+    size_t start = 0;
+
+    while (start + HeaderSize <= data.size() && memcmp(&data[start], "RTLT", 4) != 0) start++;
+
+    if (start + HeaderSize > data.size())
+    {
+        fprintf(stderr, "trace2chrome: no trace dump found in %s\n", argv[1]);
+        return 1;
+    }
+
+    const unsigned char* header = &data[start];
+    unsigned version = header[4];
+    unsigned eventSize = header[5];
+    size_t count = ReadLE(header + 6, 2);
+    uint32_t ticksPerSecond = ReadLE(header + 8, 4);
+    uint32_t recorded = ReadLE(header + 12, 4);
+
+    if (version != 1 || eventSize < 8 || ticksPerSecond == 0)
+    {
+        fprintf(stderr, "trace2chrome: unsupported dump (version %u, event size %u)\n", version, eventSize);
+        return 1;
+    }
+
+    if (start + HeaderSize + count * eventSize > data.size())
+    {
+        fprintf(stderr, "trace2chrome: dump is truncated\n");
+        count = (data.size() - start - HeaderSize) / eventSize;
+    }
+
+    if (recorded > count) fprintf(stderr, "trace2chrome: %u older events were overwritten\n", unsigned(recorded - count));
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    std::set<unsigned> contexts;
+    std::map<unsigned, unsigned> depth;
+    uint64_t time = 0, first = 0;
+    uint32_t previous = 0;
+    bool comma = false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const unsigned char* event = header + HeaderSize + i * eventSize;
+        uint32_t ticks = ReadLE(event, 4);
+        unsigned id = ReadLE(event + 4, 2);
+        char type = char(event[6]);
+        unsigned context = event[7];
+
+        // Events are in the order their slots were reserved, so an event that
+        // preempted another between reserving its slot and reading the time
+        // can be slightly earlier than the one before it. Only treat a large
+        // step backwards as the 32-bit counter wrapping.
+        if (i == 0)
+            time = first = ticks;
+        else
+            time += int64_t(int32_t(ticks - previous));
+
+        previous = ticks;
+        contexts.insert(context);
+
+        // Drop end events whose begin event was overwritten in the ring
+        if (type == 'B')
+            depth[context]++;
+        else if (type == 'E')
+        {
+            if (depth[context] == 0) continue;
+
+            depth[context]--;
+        }
+
+        printf("%s{\"name\":", comma ? ",\n" : "");
+
+        std::map<unsigned, std::string>::const_iterator name = names.find(id);
+
+        if (name != names.end())
+            WriteString(name->second);
+        else
+            printf("\"event %u\"", id);
+
+        printf(",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u", type, double(time - first) * 1e6 / ticksPerSecond, context);
+
+        if (type == 'i') printf(",\"s\":\"t\"");
+
+        printf("}");
+        comma = true;
+    }
+
+    for (unsigned context : contexts)
+    {
+        printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":", comma ? ",\n" : "", context);
+
+        if (context == 0)
+            printf("\"loop\"");
+        else
+            printf("\"ISR %u\"", context);
+
+        printf("}}");
+        comma = true;
+    }
+
+    printf("\n]}\n");
+
+    return 0;
+}